@@ -0,0 +1,74 @@
+// Contention benchmark: module-level draws from 1..N threads.
+//
+// Compares the thread-local default instance (RANDOMCPP_THREAD_LOCAL) with one shared
+// Random guarded by a mutex, which is what callers had to do before per-thread engines.
+
+#define RANDOMCPP_THREAD_LOCAL
+#include <randomcpp.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static constexpr unsigned DRAWS_PER_THREAD = 2000000;
+
+template <typename TWork>
+static double run(unsigned threads, TWork work)
+{
+   std::vector<std::thread> pool;
+   auto start = std::chrono::steady_clock::now();
+   for (unsigned t = 0; t < threads; ++t)
+   {
+      pool.emplace_back(work);
+   }
+   for (auto &thread : pool)
+   {
+      thread.join();
+   }
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   return elapsed.count();
+}
+
+int main(int argc, char **argv)
+{
+   unsigned max_threads = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+   if (max_threads == 0)
+   {
+      max_threads = 1;
+   }
+
+   randomcpp::seed(1);
+   randomcpp::Random shared(1);
+   std::mutex shared_mutex;
+
+   std::printf("%8s %18s %18s\n", "threads", "thread_local M/s", "mutex M/s");
+   for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+   {
+      double total = double(threads) * DRAWS_PER_THREAD;
+
+      double local_s = run(threads, [] {
+         volatile int sink = 0;
+         for (unsigned i = 0; i < DRAWS_PER_THREAD; ++i)
+         {
+            sink = randomcpp::randint(0, 1000);
+         }
+         (void)sink;
+      });
+
+      double mutex_s = run(threads, [&] {
+         volatile int sink = 0;
+         for (unsigned i = 0; i < DRAWS_PER_THREAD; ++i)
+         {
+            std::lock_guard<std::mutex> lock(shared_mutex);
+            sink = shared.randint(0, 1000);
+         }
+         (void)sink;
+      });
+
+      std::printf("%8u %18.1f %18.1f\n", threads, total / local_s / 1e6, total / mutex_s / 1e6);
+   }
+   return 0;
+}
@@ -0,0 +1,100 @@
+// Engine benchmark: random(), random_double() and randint() throughput of BasicRandom over each engine.
+
+#include <randomcpp.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static constexpr unsigned DRAWS = 20000000;
+
+template <typename TEngine>
+static void bench(char const *name)
+{
+   randomcpp::BasicRandom<TEngine> rng(1);
+
+   auto start = std::chrono::steady_clock::now();
+   float sum = 0.0f;
+   for (unsigned i = 0; i < DRAWS; ++i)
+   {
+      sum += rng.random();
+   }
+   std::chrono::duration<double> random_s = std::chrono::steady_clock::now() - start;
+
+   start = std::chrono::steady_clock::now();
+   double dsum = 0.0;
+   for (unsigned i = 0; i < DRAWS; ++i)
+   {
+      dsum += rng.random_double();
+   }
+   std::chrono::duration<double> double_s = std::chrono::steady_clock::now() - start;
+
+   start = std::chrono::steady_clock::now();
+   long long total = 0;
+   for (unsigned i = 0; i < DRAWS; ++i)
+   {
+      total += rng.randint(0, 1000);
+   }
+   std::chrono::duration<double> randint_s = std::chrono::steady_clock::now() - start;
+
+   std::printf("%-14s %6zu %12.2f %12.2f %12.2f   (%g %g %lld)\n", name, sizeof(TEngine),
+               random_s.count() * 1e9 / DRAWS, double_s.count() * 1e9 / DRAWS, randint_s.count() * 1e9 / DRAWS,
+               sum, dsum, total);
+}
+
+// Block output: words per ns from one std::mt19937 call per word versus sfmt19937::fill.
+static void bench_fill()
+{
+   std::vector<std::uint32_t> words(1 << 16);
+   unsigned rounds = DRAWS / words.size();
+
+   std::mt19937 mt(1);
+   auto start = std::chrono::steady_clock::now();
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      for (auto &word : words)
+      {
+         word = mt();
+      }
+   }
+   std::chrono::duration<double> mt_s = std::chrono::steady_clock::now() - start;
+
+   randomcpp::sfmt19937 sfmt(1);
+   start = std::chrono::steady_clock::now();
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      sfmt.fill(words.data(), words.size());
+   }
+   std::chrono::duration<double> sfmt_s = std::chrono::steady_clock::now() - start;
+
+   std::vector<double> reals(1 << 15);
+   start = std::chrono::steady_clock::now();
+   for (unsigned r = 0; r < rounds; ++r)
+   {
+      sfmt.fill(reals.data(), reals.size());
+   }
+   std::chrono::duration<double> real_s = std::chrono::steady_clock::now() - start;
+
+   double total = double(rounds) * words.size();
+   std::printf("\nblock fill ns/word: mt19937 %.2f, sfmt19937 %.2f, sfmt19937 doubles %.2f (%u %g)\n",
+               mt_s.count() * 1e9 / total, sfmt_s.count() * 1e9 / total,
+               real_s.count() * 1e9 / (double(rounds) * reals.size()), words[0], reals[0]);
+}
+
+int main()
+{
+   std::printf("%-14s %6s %12s %12s %12s\n", "engine", "bytes", "random ns", "double ns", "randint ns");
+   bench<std::mt19937>("mt19937");
+   bench<std::mt19937_64>("mt19937_64");
+   bench<randomcpp::splitmix64>("splitmix64");
+   bench<randomcpp::xoshiro256pp>("xoshiro256pp");
+   bench<randomcpp::xoshiro128p>("xoshiro128p");
+   bench<randomcpp::pcg32>("pcg32");
+#ifdef __SIZEOF_INT128__
+   bench<randomcpp::pcg64>("pcg64");
+#endif
+   bench<randomcpp::philox4x32>("philox4x32");
+   bench<randomcpp::sfmt19937>("sfmt19937");
+   bench_fill();
+   return 0;
+}
@@ -0,0 +1,35 @@
+// Shuffle benchmark: ns per element for shuffle(), shuffle(cache_blocked) and parallel_shuffle() on one large array.
+
+#include <randomcpp.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+template <typename TShuffle>
+static double run(std::vector<std::uint32_t> &items, TShuffle shuffle)
+{
+   std::iota(items.begin(), items.end(), 0);
+   auto start = std::chrono::steady_clock::now();
+   shuffle(&items);
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   return elapsed.count() * 1e9 / items.size();
+}
+
+int main(int argc, char **argv)
+{
+   std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 26;
+   std::vector<std::uint32_t> items(n);
+   randomcpp::BasicRandom<randomcpp::xoshiro256pp> rng(1);
+
+   double plain = run(items, [&](auto *v) { rng.shuffle(v); });
+   double blocked = run(items, [&](auto *v) { rng.shuffle(v, randomcpp::cache_blocked); });
+   double parallel = run(items, [&](auto *v) { rng.parallel_shuffle(v); });
+
+   std::printf("%zu x uint32, ns/element: shuffle %.2f, cache_blocked %.2f, parallel_shuffle %.2f (%u)\n",
+               n, plain, blocked, parallel, items[0]);
+   return 0;
+}
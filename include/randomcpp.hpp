@@ -8,32 +8,5326 @@
 #include <iterator> // std::distance
 #include <array>
 #include <unordered_map>
+#include <ctime>
+#include <cstdint>
+#include <atomic>
+#include <type_traits>
+#include <bit>
+#include <span>
+#include <cmath>
+#include <numbers>
+#include <sstream>
+#include <memory>
+#include <limits>
+#include <utility>
+#include <tuple>
+#include <thread>
+#include <exception>
+
+#if defined(__SSE2__) && !defined(RANDOMCPP_NO_SIMD)
+#include <emmintrin.h>
+#define RANDOMCPP_SFMT_SSE2
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RANDOMCPP_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define RANDOMCPP_PREFETCH(address) ((void)0)
+#endif
 
 namespace randomcpp
 {
 
-    // static unsigned seed_value;
-    inline unsigned seed_value = 0;
-    inline std::mt19937 gen(seed_value);
+    namespace _detail
+    {
+
+        // 4 * exp(-0.5) / sqrt(2), for Kinderman and Monahan's normalvariate(), at the precision of each real type.
+        template <typename TReal>
+        inline constexpr TReal nv_magicconst = static_cast<TReal>(1.71552776992141359296037928255754496L);
+
+    } // namespace _detail
+
+    inline constexpr float NV_MAGICCONST = _detail::nv_magicconst<float>;
+
+    namespace _detail
+    {
+
+        template <typename T>
+        struct has_resize
+        {
+            template <typename U, void (U::*)(std::size_t)>
+            struct resize_signature
+            {
+            };
+
+            template <typename U>
+            static char Test(resize_signature<U, &U::resize> *);
+
+
+            template <typename U>
+            static int Test(...);
+
+            static inline const bool value = sizeof(Test<T>(0)) == sizeof(char);
+
+        /* Another optional implementation */
+        // private:
+        //     template <typename U>
+        //     static auto Test(int) -> decltype(std::declval<U>().resize(std::declval<std::size_t>()), std::true_type{});
+
+        //     template <typename U>
+        //     static std::false_type Test(...);
+
+        // public:
+        //     static constexpr bool value = decltype(Test<T>(0))::value;
+        };
+
+        /*
+         * Whether an engine can write a block of TWord outputs at once (e.g. sfmt19937::fill).
+         */
+        template <typename TEngine, typename TWord>
+        struct has_fill
+        {
+        private:
+            template <typename U>
+            static auto Test(int) -> decltype(std::declval<U &>().fill(std::declval<TWord *>(), std::size_t(0)), std::true_type{});
+
+            template <typename U>
+            static std::false_type Test(...);
+
+        public:
+            static constexpr bool value = decltype(Test<TEngine>(0))::value;
+        };
+
+        /*
+         * Whether a container knows its size without walking it (std::forward_list doesn't).
+         */
+        template <typename TContainer>
+        struct has_size
+        {
+        private:
+            template <typename U>
+            static auto Test(int) -> decltype(std::declval<U const &>().size(), std::true_type{});
+
+            template <typename U>
+            static std::false_type Test(...);
+
+        public:
+            static constexpr bool value = decltype(Test<TContainer>(0))::value;
+        };
+
+        template <typename TContainer>
+        inline std::uint64_t population_size(TContainer const &population)
+        {
+            if constexpr (has_size<TContainer>::value)
+            {
+                return population.size();
+            }
+            else
+            {
+                return std::distance(population.begin(), population.end());
+            }
+        }
+
+        /*
+         * Width of the engine's output if it covers a full 32- or 64-bit word, 0 otherwise.
+         */
+        template <typename TEngine>
+        inline constexpr int engine_bits =
+            TEngine::min() == 0 && TEngine::max() == 0xFFFFFFFFu           ? 32
+            : TEngine::min() == 0 && TEngine::max() == ~std::uint64_t(0)   ? 64
+                                                                           : 0;
+
+        // Top 24 bits of a word as a float in [0, 1).
+        inline float to_float(std::uint32_t w)
+        {
+            return static_cast<float>(w >> 8) * 0x1.0p-24f;
+        }
+
+        inline float to_float(std::uint64_t w)
+        {
+            return static_cast<float>(w >> 40) * 0x1.0p-24f;
+        }
+
+        // Top 53 bits of a word as a double in [0, 1). Every value is exact, so the result never rounds up to 1.
+        inline double to_double(std::uint64_t w)
+        {
+            return static_cast<double>(w >> 11) * 0x1.0p-53;
+        }
+
+    } // namespace _detail
+
+    // Engines:
+    //   Small-state uniform random bit generators that can stand in for std::mt19937 (see BasicRandom).
+    //   Each one is seeded from a single integer through splitmix64, as recommended by the xoshiro and PCG authors,
+    //   or from a seed sequence like the standard engines.
+
+    namespace _detail
+    {
+
+        inline constexpr std::uint64_t rotl(std::uint64_t x, int k)
+        {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        inline constexpr std::uint32_t rotl(std::uint32_t x, int k)
+        {
+            return (x << k) | (x >> (32 - k));
+        }
+
+        inline constexpr std::uint64_t rotr(std::uint64_t x, unsigned k)
+        {
+            return (x >> k) | (x << ((-k) & 63));
+        }
+
+        inline constexpr std::uint32_t rotr(std::uint32_t x, unsigned k)
+        {
+            return (x >> k) | (x << ((-k) & 31));
+        }
+
+        template <typename T>
+        using enable_if_seed_seq = typename std::enable_if<!std::is_arithmetic<T>::value, int>::type;
+
+        /*
+         * Fill words from a seed sequence, two 32-bit halves per 64-bit word.
+         */
+        template <typename TSeedSeq, std::size_t N>
+        inline void generate_words(TSeedSeq &seq, std::array<std::uint64_t, N> *words)
+        {
+            std::array<std::uint32_t, 2 * N> halves;
+            seq.generate(halves.begin(), halves.end());
+            for (std::size_t i = 0; i < N; i++)
+            {
+                (*words)[i] = (std::uint64_t(halves[2 * i + 1]) << 32) | halves[2 * i];
+            }
+        }
+
+        /*
+         * Jump-ahead for F2-linear engines (Haramoto, Matsumoto, Nishimura, Panneton & L'Ecuyer, "Efficient jump ahead
+         *   for F2-linear random number generators", 2008). If p is the characteristic polynomial of the transition T,
+         *   then T^n = q(T) with q = x^n mod p, and q(T) s takes deg p steps and state additions by Horner's rule,
+         *   however large n is. p itself is recovered from 2 deg p output bits by Berlekamp-Massey.
+         *   Polynomials over GF(2) are bit vectors, the coefficient of x^i in bit i.
+         */
+        using gf2_poly = std::vector<std::uint64_t>;
+
+        inline bool gf2_bit(gf2_poly const &a, std::size_t i)
+        {
+            return i / 64 < a.size() && ((a[i / 64] >> (i % 64)) & 1);
+        }
+
+        inline std::size_t gf2_degree(gf2_poly const &a)
+        {
+            for (std::size_t w = a.size(); w-- > 0;)
+            {
+                if (a[w])
+                {
+                    return w * 64 + 63 - std::countl_zero(a[w]);
+                }
+            }
+            return 0;
+        }
+
+        // a += b * x^shift, growing a as needed.
+        inline void gf2_add_shifted(gf2_poly *a, gf2_poly const &b, std::size_t shift)
+        {
+            std::size_t words = shift / 64, bits = shift % 64;
+            if (a->size() < b.size() + words + 1)
+            {
+                a->resize(b.size() + words + 1, 0);
+            }
+            for (std::size_t i = 0; i < b.size(); i++)
+            {
+                (*a)[i + words] ^= b[i] << bits;
+                if (bits)
+                {
+                    (*a)[i + words + 1] ^= b[i] >> (64 - bits);
+                }
+            }
+        }
+
+        /*
+         * Characteristic polynomial x^L + c_1 x^(L-1) + ... + c_L of the shortest recurrence s_j = c_1 s_(j-1) + ... + c_L s_(j-L)
+         *   that generates bits (Berlekamp-Massey). 2L bits are enough to find it.
+         */
+        inline gf2_poly gf2_minimal_polynomial(std::vector<std::uint8_t> const &bits)
+        {
+            std::size_t n = bits.size();
+            // The sequence reversed, so that s_N, s_(N-1), ... are consecutive bits from n - 1 - N on.
+            gf2_poly reversed(n / 64 + 3, 0);
+            for (std::size_t i = 0; i < n; i++)
+            {
+                reversed[(n - 1 - i) / 64] |= std::uint64_t(bits[i] & 1) << ((n - 1 - i) % 64);
+            }
+            auto reversed_word = [&](std::size_t offset)
+            {
+                std::size_t w = offset / 64, b = offset % 64;
+                return b ? (reversed[w] >> b) | (reversed[w + 1] << (64 - b)) : reversed[w];
+            };
+
+            gf2_poly c{1}, b{1};
+            std::size_t length = 0, gap = 1;
+            for (std::size_t N = 0; N < n; N++)
+            {
+                // Discrepancy: s_N + c_1 s_(N-1) + ... + c_L s_(N-L).
+                std::uint64_t parity = 0;
+                for (std::size_t w = 0; w <= length / 64 && w < c.size(); w++)
+                {
+                    parity ^= c[w] & reversed_word(n - 1 - N + 64 * w);
+                }
+                if (!(std::popcount(parity) & 1))
+                {
+                    gap++;
+                    continue;
+                }
+                if (2 * length <= N)
+                {
+                    gf2_poly previous = c;
+                    gf2_add_shifted(&c, b, gap);
+                    length = N + 1 - length;
+                    b = std::move(previous);
+                    gap = 1;
+                }
+                else
+                {
+                    gf2_add_shifted(&c, b, gap);
+                    gap++;
+                }
+            }
+
+            gf2_poly p(length / 64 + 1, 0);
+            for (std::size_t i = 0; i <= length; i++)
+            {
+                if (gf2_bit(c, i))
+                {
+                    p[(length - i) / 64] |= std::uint64_t(1) << ((length - i) % 64);
+                }
+            }
+            return p;
+        }
+
+        // a mod p, where p has degree d; the result has d / 64 + 1 words.
+        inline void gf2_reduce(gf2_poly *a, gf2_poly const &p, std::size_t d)
+        {
+            for (std::size_t i = a->size() * 64; i-- > d;)
+            {
+                if ((*a)[i / 64] == 0)
+                {
+                    i -= i % 64;
+                    continue;
+                }
+                if (((*a)[i / 64] >> (i % 64)) & 1)
+                {
+                    gf2_add_shifted(a, p, i - d);
+                }
+            }
+            a->resize(d / 64 + 1);
+        }
+
+        // Each bit i of w moved to bit 2i of the result, as two words.
+        inline std::uint64_t gf2_spread(std::uint32_t w)
+        {
+            std::uint64_t x = w;
+            x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+            x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+            x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+            x = (x | (x << 2)) & 0x3333333333333333ull;
+            return (x | (x << 1)) & 0x5555555555555555ull;
+        }
+
+        // a^2 mod p: squaring over GF(2) just spreads the bits out.
+        inline gf2_poly gf2_square_mod(gf2_poly const &a, gf2_poly const &p)
+        {
+            gf2_poly square(2 * a.size(), 0);
+            for (std::size_t i = 0; i < a.size(); i++)
+            {
+                square[2 * i] = gf2_spread(static_cast<std::uint32_t>(a[i]));
+                square[2 * i + 1] = gf2_spread(static_cast<std::uint32_t>(a[i] >> 32));
+            }
+            gf2_reduce(&square, p, gf2_degree(p));
+            return square;
+        }
+
+        // x^n mod p, by left-to-right square-and-multiply; multiplying by x is a one-bit shift.
+        inline gf2_poly gf2_pow_x_mod(std::uint64_t n, gf2_poly const &p)
+        {
+            std::size_t d = gf2_degree(p);
+            gf2_poly r(d / 64 + 1, 0);
+            r[0] = 1;
+            for (int bit = 63 - std::countl_zero(n | 1); bit >= 0; bit--)
+            {
+                r = gf2_square_mod(r, p);
+                if ((n >> bit) & 1)
+                {
+                    std::uint64_t carry = 0;
+                    for (auto &word : r)
+                    {
+                        std::uint64_t next = word >> 63;
+                        word = (word << 1) | carry;
+                        carry = next;
+                    }
+                    if (gf2_bit(r, d))
+                    {
+                        for (std::size_t w = 0; w < p.size(); w++)
+                        {
+                            r[w] ^= p[w];
+                        }
+                    }
+                }
+            }
+            return r;
+        }
+
+        /*
+         * q(T) s by Horner's rule. TState provides step() (apply T) and ^= (add states).
+         */
+        template <typename TState>
+        inline TState gf2_apply(gf2_poly const &q, TState const &s)
+        {
+            std::size_t top = gf2_degree(q);
+            TState acc = s;
+            for (std::size_t k = top; k-- > 0;)
+            {
+                acc.step();
+                if (gf2_bit(q, k))
+                {
+                    acc ^= s;
+                }
+            }
+            return acc;
+        }
+
+        // The characteristic polynomial of TState's transition, from the low bit of its first word.
+        template <typename TState>
+        inline gf2_poly gf2_characteristic_polynomial(TState s, std::size_t degree)
+        {
+            std::vector<std::uint8_t> bits(2 * degree);
+            for (auto &bit : bits)
+            {
+                bit = s.low_bit();
+                s.step();
+            }
+            return gf2_minimal_polynomial(bits);
+        }
+
+        // The xoshiro state transitions, shared by the engines and their jump-ahead.
+        inline void xoshiro256_step(std::array<std::uint64_t, 4> &s)
+        {
+            std::uint64_t const t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+        }
+
+        inline void xoshiro128_step(std::array<std::uint32_t, 4> &s)
+        {
+            std::uint32_t const t = s[1] << 9;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 11);
+        }
+
+        /*
+         * A xoshiro state as an element of the GF(2) vector space its transition acts on.
+         */
+        template <typename TWord, void (*Step)(std::array<TWord, 4> &)>
+        struct xoshiro_state
+        {
+            using word_type = TWord;
+
+            std::array<TWord, 4> words;
+
+            void step() { Step(words); }
+
+            bool low_bit() const { return words[0] & 1; }
+
+            xoshiro_state &operator^=(xoshiro_state const &other)
+            {
+                for (std::size_t i = 0; i < 4; i++)
+                {
+                    words[i] ^= other.words[i];
+                }
+                return *this;
+            }
+        };
+
+        using xoshiro256_state = xoshiro_state<std::uint64_t, xoshiro256_step>;
+        using xoshiro128_state = xoshiro_state<std::uint32_t, xoshiro128_step>;
+
+        template <typename TState>
+        inline gf2_poly const &xoshiro_polynomial()
+        {
+            static gf2_poly const p = gf2_characteristic_polynomial(TState{{1, 0, 0, 0}}, 32 * sizeof(typename TState::word_type));
+            return p;
+        }
+
+        /*
+         * Advance a xoshiro state by z steps: stepping for short distances, the polynomial jump for long ones.
+         */
+        template <typename TState, typename TWord>
+        inline void xoshiro_discard(std::array<TWord, 4> *words, unsigned long long z)
+        {
+            TState s{*words};
+            if (z < (1u << 14))
+            {
+                for (; z; z--)
+                {
+                    s.step();
+                }
+            }
+            else
+            {
+                s = gf2_apply(gf2_pow_x_mod(z, xoshiro_polynomial<TState>()), s);
+            }
+            *words = s.words;
+        }
+
+        /*
+         * The reference xoshiro jump functions: add up the states along the way, selected by the bits of
+         *   the precomputed x^distance mod p.
+         */
+        template <typename TState, typename TWord>
+        inline void xoshiro_jump(std::array<TWord, 4> *words, std::array<TWord, 4> const &polynomial)
+        {
+            TState s{*words}, acc{{0, 0, 0, 0}};
+            for (TWord word : polynomial)
+            {
+                for (int b = 0; b < int(8 * sizeof(TWord)); b++)
+                {
+                    if ((word >> b) & 1)
+                    {
+                        acc ^= s;
+                    }
+                    s.step();
+                }
+            }
+            *words = acc.words;
+        }
+
+        template <typename T>
+        struct is_mersenne_twister : std::false_type
+        {
+        };
+
+        template <typename TWord, std::size_t w, std::size_t n, std::size_t m, std::size_t r, TWord a, std::size_t u, TWord d,
+                  std::size_t s, TWord b, std::size_t t, TWord c, std::size_t l, TWord f>
+        struct is_mersenne_twister<std::mersenne_twister_engine<TWord, w, n, m, r, a, u, d, s, b, t, c, l, f>> : std::true_type
+        {
+        };
+
+        /*
+         * The std::mersenne_twister_engine recurrence x[k+n] = x[k+m] ^ A(upper w-r bits of x[k] | lower r bits of x[k+1]),
+         *   on a ring of the last n untempered words. The lower r bits of the oldest word never reach the output.
+         */
+        template <typename TEngine>
+        struct mt_window
+        {
+            using word_type = std::conditional_t<TEngine::word_size <= 32, std::uint32_t, std::uint64_t>;
+
+            static constexpr std::size_t n = TEngine::state_size, m = TEngine::shift_size;
+            static constexpr word_type lower_mask = (word_type(1) << TEngine::mask_bits) - 1;
+            static constexpr word_type word_mask = ~word_type(0) >> (8 * sizeof(word_type) - TEngine::word_size);
+            static constexpr word_type upper_mask = word_mask & ~lower_mask;
+
+            std::array<word_type, n> words;
+            std::size_t head = 0;
+
+            word_type operator[](std::size_t i) const
+            {
+                return words[head + i < n ? head + i : head + i - n];
+            }
+
+            void step()
+            {
+                word_type y = ((*this)[0] & upper_mask) | ((*this)[1] & lower_mask);
+                words[head] = (*this)[m] ^ (y >> 1) ^ ((y & 1) ? word_type(TEngine::xor_mask) : word_type(0));
+                head = head + 1 < n ? head + 1 : 0;
+            }
+
+            bool low_bit() const { return (*this)[n - 1] & 1; }
+
+            mt_window &operator^=(mt_window const &other)
+            {
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    words[head + i < n ? head + i : head + i - n] ^= other[i];
+                }
+                return *this;
+            }
+        };
+
+        /*
+         * Inverse of the output tempering: each step y ^= (y >> shift) & mask is undone by repeating it
+         *   until every bit has been corrected, w / shift + 1 times.
+         */
+        template <typename TEngine>
+        inline typename mt_window<TEngine>::word_type mt_untemper(typename mt_window<TEngine>::word_type y)
+        {
+            using word_type = typename mt_window<TEngine>::word_type;
+            constexpr std::size_t w = TEngine::word_size;
+            constexpr word_type word_mask = mt_window<TEngine>::word_mask;
+            auto undo_right = [](word_type y, std::size_t shift, word_type mask)
+            {
+                word_type x = y;
+                for (std::size_t i = 0; i < w / shift + 1; i++)
+                {
+                    x = y ^ ((x >> shift) & mask);
+                }
+                return x;
+            };
+            auto undo_left = [](word_type y, std::size_t shift, word_type mask)
+            {
+                word_type x = y;
+                for (std::size_t i = 0; i < w / shift + 1; i++)
+                {
+                    x = y ^ ((x << shift) & mask & word_mask);
+                }
+                return x;
+            };
+            y = undo_right(y, TEngine::tempering_l, word_mask);
+            y = undo_left(y, TEngine::tempering_t, word_type(TEngine::tempering_c));
+            y = undo_left(y, TEngine::tempering_s, word_type(TEngine::tempering_b));
+            return undo_right(y, TEngine::tempering_u, word_type(TEngine::tempering_d));
+        }
+
+        template <typename TEngine>
+        inline mt_window<TEngine> mt_next_window(TEngine gen)
+        {
+            mt_window<TEngine> window;
+            for (auto &word : window.words)
+            {
+                word = mt_untemper<TEngine>(static_cast<typename mt_window<TEngine>::word_type>(gen()));
+            }
+            return window;
+        }
+
+        template <typename TEngine>
+        inline gf2_poly const &mt_polynomial()
+        {
+            static gf2_poly const p = gf2_characteristic_polynomial(mt_next_window(TEngine()),
+                                                                    TEngine::state_size * TEngine::word_size - TEngine::mask_bits);
+            return p;
+        }
+
+        /*
+         * Polynomial jump for a std::mersenne_twister_engine, given q = x^(z - n - 1) mod p for a jump of z > n outputs.
+         *   The window after z - n - 1 steps from the next n words has the right live bits; one more step makes the
+         *   oldest word exact too. The engine is then reloaded through its textual representation, which the standard
+         *   defines as the last n words; libstdc++ also reads its position in the block, which n puts at the end.
+         */
+        template <typename TEngine>
+        inline void mt_jump(TEngine *gen, gf2_poly const &q)
+        {
+            auto window = gf2_apply(q, mt_next_window(*gen));
+            window.step();
+
+            std::stringstream stream;
+            stream.imbue(std::locale::classic());
+            for (std::size_t i = 0; i < TEngine::state_size; i++)
+            {
+                stream << window[i] << ' ';
+            }
+#ifdef __GLIBCXX__
+            stream << TEngine::state_size;
+#endif
+            stream >> *gen;
+        }
+
+        // Jumps shorter than this are cheaper to step through.
+        inline constexpr unsigned long long mt_jump_threshold = 1ull << 20;
+
+        template <typename TEngine>
+        inline void mt_jump(TEngine *gen, unsigned long long z)
+        {
+            if (z < mt_jump_threshold)
+            {
+                gen->discard(z);
+                return;
+            }
+            mt_jump(gen, gf2_pow_x_mod(z - TEngine::state_size - 1, mt_polynomial<TEngine>()));
+        }
+
+        // q for a jump of 2^64 outputs.
+        template <typename TEngine>
+        inline gf2_poly const &mt_long_jump()
+        {
+            static gf2_poly const q = gf2_pow_x_mod(~0ull - TEngine::state_size, mt_polynomial<TEngine>());
+            return q;
+        }
+
+    } // namespace _detail
+
+    /*
+     * SplitMix64 (Steele, Lea & Flood). One 64-bit word of state; also used to seed the other engines.
+     */
+    class splitmix64
+    {
+    public:
+        using result_type = std::uint64_t;
+
+        static constexpr result_type default_seed = 0;
+
+        splitmix64() : splitmix64(default_seed) {}
+
+        explicit splitmix64(std::uint64_t s) { seed(s); }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        explicit splitmix64(TSeedSeq &seq) { seed(seq); }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        void seed(std::uint64_t s = default_seed)
+        {
+            state = s;
+        }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        void seed(TSeedSeq &seq)
+        {
+            std::array<std::uint64_t, 1> words;
+            _detail::generate_words(seq, &words);
+            state = words[0];
+        }
+
+        result_type operator()()
+        {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+        void discard(unsigned long long z)
+        {
+            state += z * 0x9e3779b97f4a7c15;
+        }
+
+        // Advance by 2^48 outputs.
+        void long_jump()
+        {
+            discard(1ull << 48);
+        }
+
+        // Raw state, for BasicRandom::getstate()/setstate().
+        std::array<std::uint64_t, 1> state_words() const { return {state}; }
+
+        void set_state_words(std::array<std::uint64_t, 1> const &words) { state = words[0]; }
+
+        friend bool operator==(splitmix64 const &lhs, splitmix64 const &rhs) { return lhs.state == rhs.state; }
+
+    private:
+        std::uint64_t state;
+    };
+
+    /*
+     * xoshiro256++ 1.0 (Blackman & Vigna). 32 bytes of state, 64-bit output, period 2^256 - 1.
+     */
+    class xoshiro256pp
+    {
+    public:
+        using result_type = std::uint64_t;
+
+        static constexpr result_type default_seed = 0;
+
+        xoshiro256pp() : xoshiro256pp(default_seed) {}
+
+        explicit xoshiro256pp(std::uint64_t s) { seed(s); }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        explicit xoshiro256pp(TSeedSeq &seq) { seed(seq); }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        void seed(std::uint64_t s = default_seed)
+        {
+            splitmix64 sm(s);
+            for (auto &word : state)
+            {
+                word = sm();
+            }
+        }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        void seed(TSeedSeq &seq)
+        {
+            _detail::generate_words(seq, &state);
+            if (!(state[0] | state[1] | state[2] | state[3]))
+            {
+                seed();
+            }
+        }
+
+        result_type operator()()
+        {
+            std::uint64_t const result = _detail::rotl(state[0] + state[3], 23) + state[0];
+            _detail::xoshiro256_step(state);
+            return result;
+        }
+
+        /*
+         * Advance by z outputs; long distances use the polynomial jump, in about 256 steps.
+         */
+        void discard(unsigned long long z)
+        {
+            _detail::xoshiro_discard<_detail::xoshiro256_state>(&state, z);
+        }
+
+        /*
+         * Advance by 2^128 outputs (jump) or 2^192 outputs (long_jump), as the reference implementation:
+         *   2^128 non-overlapping substreams of length 2^128, or 2^64 of length 2^192.
+         */
+        void jump()
+        {
+            _detail::xoshiro_jump<_detail::xoshiro256_state>(
+                &state, {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c});
+        }
+
+        void long_jump()
+        {
+            _detail::xoshiro_jump<_detail::xoshiro256_state>(
+                &state, {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635});
+        }
+
+        // Raw state, for BasicRandom::getstate()/setstate().
+        std::array<std::uint64_t, 4> state_words() const { return state; }
+
+        void set_state_words(std::array<std::uint64_t, 4> const &words) { state = words; }
+
+        friend bool operator==(xoshiro256pp const &lhs, xoshiro256pp const &rhs) { return lhs.state == rhs.state; }
+
+    private:
+        std::array<std::uint64_t, 4> state;
+    };
+
+    /*
+     * xoshiro128+ 1.0 (Blackman & Vigna). 16 bytes of state, 32-bit output, period 2^128 - 1.
+     *   The lowest bits are weak; it is meant for floating-point generation, where only the upper bits are used.
+     */
+    class xoshiro128p
+    {
+    public:
+        using result_type = std::uint32_t;
+
+        static constexpr result_type default_seed = 0;
+
+        xoshiro128p() : xoshiro128p(default_seed) {}
+
+        explicit xoshiro128p(std::uint64_t s) { seed(s); }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        explicit xoshiro128p(TSeedSeq &seq) { seed(seq); }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        void seed(std::uint64_t s = default_seed)
+        {
+            splitmix64 sm(s);
+            std::uint64_t lo = sm(), hi = sm();
+            state = {std::uint32_t(lo), std::uint32_t(lo >> 32), std::uint32_t(hi), std::uint32_t(hi >> 32)};
+        }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        void seed(TSeedSeq &seq)
+        {
+            seq.generate(state.begin(), state.end());
+            if (!(state[0] | state[1] | state[2] | state[3]))
+            {
+                seed();
+            }
+        }
+
+        result_type operator()()
+        {
+            std::uint32_t const result = state[0] + state[3];
+            _detail::xoshiro128_step(state);
+            return result;
+        }
+
+        /*
+         * Advance by z outputs; long distances use the polynomial jump, in about 128 steps.
+         */
+        void discard(unsigned long long z)
+        {
+            _detail::xoshiro_discard<_detail::xoshiro128_state>(&state, z);
+        }
+
+        /*
+         * Advance by 2^64 outputs (jump) or 2^96 outputs (long_jump), as the reference implementation.
+         */
+        void jump()
+        {
+            _detail::xoshiro_jump<_detail::xoshiro128_state>(&state, {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b});
+        }
+
+        void long_jump()
+        {
+            _detail::xoshiro_jump<_detail::xoshiro128_state>(&state, {0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662});
+        }
+
+        // Raw state, two 32-bit words to a 64-bit one.
+        std::array<std::uint64_t, 2> state_words() const
+        {
+            return {(std::uint64_t(state[1]) << 32) | state[0], (std::uint64_t(state[3]) << 32) | state[2]};
+        }
+
+        void set_state_words(std::array<std::uint64_t, 2> const &words)
+        {
+            state = {std::uint32_t(words[0]), std::uint32_t(words[0] >> 32), std::uint32_t(words[1]), std::uint32_t(words[1] >> 32)};
+        }
+
+        friend bool operator==(xoshiro128p const &lhs, xoshiro128p const &rhs) { return lhs.state == rhs.state; }
+
+    private:
+        std::array<std::uint32_t, 4> state;
+    };
+
+    /*
+     * PCG32 (O'Neill), XSH-RR output on a 64-bit LCG. 16 bytes of state, 32-bit output.
+     *   The stream selects one of 2^63 distinct increments; pcg32(42, 54) matches the reference pcg32_srandom_r(42, 54).
+     */
+    class pcg32
+    {
+    public:
+        using result_type = std::uint32_t;
+
+        static constexpr result_type default_seed = 0;
+        static constexpr std::uint64_t multiplier = 6364136223846793005ULL;
+        static constexpr std::uint64_t default_stream = 0xda3e39cb94b95bdbULL >> 1;
+
+        pcg32() : pcg32(default_seed) {}
+
+        explicit pcg32(std::uint64_t s, std::uint64_t stream = default_stream) { seed(s, stream); }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        explicit pcg32(TSeedSeq &seq) { seed(seq); }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        void seed(std::uint64_t s = default_seed, std::uint64_t stream = default_stream)
+        {
+            state = 0;
+            increment = (stream << 1) | 1;
+            step();
+            state += s;
+            step();
+        }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        void seed(TSeedSeq &seq)
+        {
+            std::array<std::uint64_t, 2> words;
+            _detail::generate_words(seq, &words);
+            seed(words[0], words[1]);
+        }
+
+        result_type operator()()
+        {
+            std::uint64_t old = state;
+            step();
+            std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+            return _detail::rotr(xorshifted, static_cast<unsigned>(old >> 59));
+        }
+
+        /*
+         * Advance the LCG by z steps in O(log z) (Brown, "Random number generation with arbitrary strides").
+         */
+        void discard(unsigned long long z)
+        {
+            std::uint64_t acc_mult = 1, acc_plus = 0, cur_mult = multiplier, cur_plus = increment;
+            for (; z; z >>= 1)
+            {
+                if (z & 1)
+                {
+                    acc_mult *= cur_mult;
+                    acc_plus = acc_plus * cur_mult + cur_plus;
+                }
+                cur_plus = (cur_mult + 1) * cur_plus;
+                cur_mult *= cur_mult;
+            }
+            state = acc_mult * state + acc_plus;
+        }
+
+        // Advance by 2^48 outputs, splitting the 2^64 period into 2^16 substreams.
+        void long_jump()
+        {
+            discard(1ull << 48);
+        }
+
+        // Raw state and increment, for BasicRandom::getstate()/setstate().
+        std::array<std::uint64_t, 2> state_words() const { return {state, increment}; }
+
+        void set_state_words(std::array<std::uint64_t, 2> const &words)
+        {
+            state = words[0];
+            increment = words[1];
+        }
+
+        friend bool operator==(pcg32 const &lhs, pcg32 const &rhs)
+        {
+            return lhs.state == rhs.state && lhs.increment == rhs.increment;
+        }
+
+    private:
+        void step()
+        {
+            state = state * multiplier + increment;
+        }
+
+        std::uint64_t state;
+        std::uint64_t increment;
+    };
+
+#ifdef __SIZEOF_INT128__
+    /*
+     * PCG64 (O'Neill), XSL-RR output on a 128-bit LCG. 32 bytes of state, 64-bit output.
+     *   Only available where the compiler provides unsigned __int128.
+     */
+    class pcg64
+    {
+    public:
+        using result_type = std::uint64_t;
+        using state_type = unsigned __int128;
+
+        static constexpr result_type default_seed = 0;
+        static constexpr state_type multiplier =
+            (state_type(2549297995355413924ULL) << 64) | 4865540595714422341ULL;
+        static constexpr state_type default_stream =
+            ((state_type(6364136223846793005ULL) << 64) | 1442695040888963407ULL) >> 1;
+
+        pcg64() : pcg64(default_seed) {}
+
+        explicit pcg64(state_type s, state_type stream = default_stream) { seed(s, stream); }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        explicit pcg64(TSeedSeq &seq) { seed(seq); }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        void seed(state_type s = default_seed, state_type stream = default_stream)
+        {
+            state = 0;
+            increment = (stream << 1) | 1;
+            step();
+            state += s;
+            step();
+        }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        void seed(TSeedSeq &seq)
+        {
+            std::array<std::uint64_t, 4> words;
+            _detail::generate_words(seq, &words);
+            seed((state_type(words[0]) << 64) | words[1], (state_type(words[2]) << 64) | words[3]);
+        }
+
+        result_type operator()()
+        {
+            step();
+            return _detail::rotr(std::uint64_t(state >> 64) ^ std::uint64_t(state), static_cast<unsigned>(state >> 122));
+        }
+
+        void discard(unsigned long long z)
+        {
+            advance(z);
+        }
+
+        // Advance by 2^64 outputs.
+        void long_jump()
+        {
+            advance(state_type(1) << 64);
+        }
+
+        // Raw state and increment, high half first.
+        std::array<std::uint64_t, 4> state_words() const
+        {
+            return {std::uint64_t(state >> 64), std::uint64_t(state), std::uint64_t(increment >> 64), std::uint64_t(increment)};
+        }
+
+        void set_state_words(std::array<std::uint64_t, 4> const &words)
+        {
+            state = (state_type(words[0]) << 64) | words[1];
+            increment = (state_type(words[2]) << 64) | words[3];
+        }
+
+        friend bool operator==(pcg64 const &lhs, pcg64 const &rhs)
+        {
+            return lhs.state == rhs.state && lhs.increment == rhs.increment;
+        }
+
+    private:
+        void advance(state_type z)
+        {
+            state_type acc_mult = 1, acc_plus = 0, cur_mult = multiplier, cur_plus = increment;
+            for (; z; z >>= 1)
+            {
+                if (z & 1)
+                {
+                    acc_mult *= cur_mult;
+                    acc_plus = acc_plus * cur_mult + cur_plus;
+                }
+                cur_plus = (cur_mult + 1) * cur_plus;
+                cur_mult *= cur_mult;
+            }
+            state = acc_mult * state + acc_plus;
+        }
+
+        void step()
+        {
+            state = state * multiplier + increment;
+        }
+
+        state_type state;
+        state_type increment;
+    };
+#endif
+
+    namespace _detail
+    {
+
+        /*
+         * One Philox4x32-10 block: ten rounds of the Salmon et al. (SC'11) bijection over a 128-bit counter.
+         */
+        inline std::array<std::uint32_t, 4> philox4x32_10(std::array<std::uint32_t, 4> ctr, std::array<std::uint32_t, 2> key)
+        {
+            for (int round = 0; round < 10; round++)
+            {
+                if (round)
+                {
+                    key[0] += 0x9E3779B9;
+                    key[1] += 0xBB67AE85;
+                }
+                std::uint64_t p0 = std::uint64_t(0xD2511F53) * ctr[0];
+                std::uint64_t p1 = std::uint64_t(0xCD9E8D57) * ctr[2];
+                ctr = {std::uint32_t(p1 >> 32) ^ ctr[1] ^ key[0], std::uint32_t(p1),
+                       std::uint32_t(p0 >> 32) ^ ctr[3] ^ key[1], std::uint32_t(p0)};
+            }
+            return ctr;
+        }
+
+        /*
+         * One Threefry2x64-20 block (Salmon et al., SC'11): the Threefish-256 round function reduced to two words,
+         *   with a key injection every four rounds.
+         */
+        inline std::array<std::uint64_t, 2> threefry2x64_20(std::array<std::uint64_t, 2> ctr, std::array<std::uint64_t, 2> key)
+        {
+            constexpr int rotations[8] = {16, 42, 12, 31, 16, 32, 24, 21};
+            std::uint64_t const schedule[3] = {key[0], key[1], 0x1BD11BDAA9FC1A22 ^ key[0] ^ key[1]};
+            ctr[0] += schedule[0];
+            ctr[1] += schedule[1];
+            for (int round = 0; round < 20; round++)
+            {
+                ctr[0] += ctr[1];
+                ctr[1] = rotl(ctr[1], rotations[round % 8]) ^ ctr[0];
+                if (round % 4 == 3)
+                {
+                    int injection = round / 4 + 1;
+                    ctr[0] += schedule[injection % 3];
+                    ctr[1] += schedule[(injection + 1) % 3] + injection;
+                }
+            }
+            return ctr;
+        }
+
+    } // namespace _detail
+
+    /*
+     * Philox4x32-10 (Salmon, Moraes, Dror & Shaw). Counter-based: the output is a keyed bijection of a 128-bit counter,
+     *   so the state is just the key and the counter, and discard() is O(1).
+     */
+    class philox4x32
+    {
+    public:
+        using result_type = std::uint32_t;
+
+        static constexpr result_type default_seed = 0;
+
+        philox4x32() : philox4x32(default_seed) {}
+
+        explicit philox4x32(std::uint64_t s) { seed(s); }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        explicit philox4x32(TSeedSeq &seq) { seed(seq); }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        void seed(std::uint64_t s = default_seed)
+        {
+            key = {std::uint32_t(s), std::uint32_t(s >> 32)};
+            counter = {0, 0, 0, 0};
+            index = 4;
+        }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        void seed(TSeedSeq &seq)
+        {
+            seq.generate(key.begin(), key.end());
+            counter = {0, 0, 0, 0};
+            index = 4;
+        }
+
+        result_type operator()()
+        {
+            if (index == 4)
+            {
+                block = _detail::philox4x32_10(counter, key);
+                increment();
+                index = 0;
+            }
+            return block[index++];
+        }
+
+        void discard(unsigned long long z)
+        {
+            std::uint64_t position = this->position() + z;
+            set_position(position);
+        }
+
+        /*
+         * Advance by 2^66 outputs: the next value of the upper 64 counter bits, at the same position.
+         */
+        void long_jump()
+        {
+            std::uint64_t position = this->position();
+            if (++counter[2] == 0)
+            {
+                ++counter[3];
+            }
+            set_position(position);
+        }
+
+        /*
+         * Key and counter access, for random access into the stream.
+         */
+        std::array<std::uint32_t, 2> const &get_key() const { return key; }
+
+        void set_counter(std::array<std::uint32_t, 4> const &ctr)
+        {
+            counter = ctr;
+            index = 4;
+        }
+
+        /*
+         * Key, counter and position in the current block. The block itself is recomputed on load.
+         */
+        std::array<std::uint64_t, 4> state_words() const
+        {
+            return {(std::uint64_t(key[1]) << 32) | key[0], (std::uint64_t(counter[1]) << 32) | counter[0],
+                    (std::uint64_t(counter[3]) << 32) | counter[2], index};
+        }
+
+        void set_state_words(std::array<std::uint64_t, 4> const &words)
+        {
+            key = {std::uint32_t(words[0]), std::uint32_t(words[0] >> 32)};
+            counter = {std::uint32_t(words[1]), std::uint32_t(words[1] >> 32), std::uint32_t(words[2]), std::uint32_t(words[2] >> 32)};
+            index = words[3] < 4 ? static_cast<unsigned>(words[3]) : 4;
+            if (index < 4)
+            {
+                auto previous = counter;
+                for (auto &word : previous)
+                {
+                    if (word--)
+                    {
+                        break;
+                    }
+                }
+                block = _detail::philox4x32_10(previous, key);
+            }
+        }
+
+        friend bool operator==(philox4x32 const &lhs, philox4x32 const &rhs)
+        {
+            return lhs.key == rhs.key && lhs.counter == rhs.counter && lhs.index == rhs.index;
+        }
+
+    private:
+        // Number of 32-bit words drawn so far, within the low 64 bits of the counter.
+        std::uint64_t position() const
+        {
+            std::uint64_t blocks = (std::uint64_t(counter[1]) << 32) | counter[0];
+            return index == 4 ? blocks * 4 : (blocks - 1) * 4 + index;
+        }
+
+        void set_position(std::uint64_t position)
+        {
+            std::uint64_t blocks = position / 4;
+            counter[0] = std::uint32_t(blocks);
+            counter[1] = std::uint32_t(blocks >> 32);
+            index = 4;
+            if (position % 4)
+            {
+                (*this)();
+                index = static_cast<unsigned>(position % 4);
+            }
+        }
+
+        void increment()
+        {
+            for (auto &word : counter)
+            {
+                if (++word)
+                {
+                    break;
+                }
+            }
+        }
+
+        std::array<std::uint32_t, 2> key;
+        std::array<std::uint32_t, 4> counter;
+        std::array<std::uint32_t, 4> block;
+        unsigned index;
+    };
+
+    namespace _detail
+    {
+
+        // SFMT19937 parameters (Saito & Matsumoto, "SIMD-oriented Fast Mersenne Twister", 2008).
+        namespace sfmt
+        {
+            inline constexpr std::size_t N = 156; // 128-bit words of state
+            inline constexpr std::size_t N32 = N * 4;
+            inline constexpr std::size_t POS1 = 122;
+            inline constexpr int SL1 = 18;
+            inline constexpr int SL2 = 1;
+            inline constexpr int SR1 = 11;
+            inline constexpr int SR2 = 1;
+            inline constexpr std::uint32_t MSK[4] = {0xdfffffefU, 0xddfecb7fU, 0xbffaffffU, 0xbffffff6U};
+            inline constexpr std::uint32_t PARITY[4] = {0x00000001U, 0x00000000U, 0x00000000U, 0x13c9e684U};
+
+            /*
+             * r = a ^ (a << 8*SL2) ^ ((b >> SR1) & MSK) ^ (c >> 8*SR2) ^ (d << SL1), with 128-bit byte shifts on a and c.
+             */
+            inline void recursion_scalar(std::uint32_t *r, std::uint32_t const *a, std::uint32_t const *b,
+                                         std::uint32_t const *c, std::uint32_t const *d)
+            {
+                std::uint64_t ah = (std::uint64_t(a[3]) << 32) | a[2], al = (std::uint64_t(a[1]) << 32) | a[0];
+                std::uint64_t xh = (ah << (SL2 * 8)) | (al >> (64 - SL2 * 8)), xl = al << (SL2 * 8);
+                std::uint64_t ch = (std::uint64_t(c[3]) << 32) | c[2], cl = (std::uint64_t(c[1]) << 32) | c[0];
+                std::uint64_t yh = ch >> (SR2 * 8), yl = (cl >> (SR2 * 8)) | (ch << (64 - SR2 * 8));
+                std::uint32_t x[4] = {std::uint32_t(xl), std::uint32_t(xl >> 32), std::uint32_t(xh), std::uint32_t(xh >> 32)};
+                std::uint32_t y[4] = {std::uint32_t(yl), std::uint32_t(yl >> 32), std::uint32_t(yh), std::uint32_t(yh >> 32)};
+                for (int i = 0; i < 4; i++)
+                {
+                    r[i] = a[i] ^ x[i] ^ ((b[i] >> SR1) & MSK[i]) ^ y[i] ^ (d[i] << SL1);
+                }
+            }
+
+            inline void gen_rand_all_scalar(std::uint32_t *state)
+            {
+                std::uint32_t *r1 = state + 4 * (N - 2), *r2 = state + 4 * (N - 1);
+                for (std::size_t i = 0; i < N; i++)
+                {
+                    std::uint32_t *w = state + 4 * i;
+                    recursion_scalar(w, w, state + 4 * ((i + POS1) % N), r1, r2);
+                    r1 = r2;
+                    r2 = w;
+                }
+            }
+
+#ifdef RANDOMCPP_SFMT_SSE2
+            /*
+             * The same recursion on one 128-bit register per state word. The lag-1/lag-2 feedback (c, d) makes each
+             *   word depend on the previous two, so wider vectors cannot compute several words at once.
+             */
+            inline void gen_rand_all_sse2(std::uint32_t *state)
+            {
+                __m128i const mask = _mm_set_epi32(MSK[3], MSK[2], MSK[1], MSK[0]);
+                __m128i *w = reinterpret_cast<__m128i *>(state);
+                __m128i r1 = _mm_load_si128(w + N - 2), r2 = _mm_load_si128(w + N - 1);
+                for (std::size_t i = 0; i < N; i++)
+                {
+                    __m128i a = _mm_load_si128(w + i);
+                    __m128i b = _mm_load_si128(w + (i + POS1) % N);
+                    __m128i r = _mm_xor_si128(a, _mm_slli_si128(a, SL2));
+                    r = _mm_xor_si128(r, _mm_and_si128(_mm_srli_epi32(b, SR1), mask));
+                    r = _mm_xor_si128(r, _mm_srli_si128(r1, SR2));
+                    r = _mm_xor_si128(r, _mm_slli_epi32(r2, SL1));
+                    _mm_store_si128(w + i, r);
+                    r1 = r2;
+                    r2 = r;
+                }
+            }
+#endif
+
+            inline void gen_rand_all(std::uint32_t *state)
+            {
+#ifdef RANDOMCPP_SFMT_SSE2
+                gen_rand_all_sse2(state);
+#else
+                gen_rand_all_scalar(state);
+#endif
+            }
+
+            /*
+             * Make sure the state is not in the small invariant subspace that would shorten the period.
+             */
+            inline void period_certification(std::uint32_t *state)
+            {
+                std::uint32_t inner = 0;
+                for (int i = 0; i < 4; i++)
+                {
+                    inner ^= state[i] & PARITY[i];
+                }
+                for (int i = 16; i > 0; i >>= 1)
+                {
+                    inner ^= inner >> i;
+                }
+                if (inner & 1)
+                {
+                    return;
+                }
+                for (int i = 0; i < 4; i++)
+                {
+                    for (std::uint32_t work = 1; work; work <<= 1)
+                    {
+                        if (work & PARITY[i])
+                        {
+                            state[i] ^= work;
+                            return;
+                        }
+                    }
+                }
+            }
+
+            /*
+             * The recursion as a ring of the last N 128-bit words: stepping it regenerates one word, in the same
+             *   order gen_rand_all() regenerates a block, so N steps from a block give the next block.
+             */
+            struct window
+            {
+                std::array<std::uint32_t, N32> words;
+                std::size_t head = 0;
+
+                std::uint32_t const *operator[](std::size_t i) const
+                {
+                    return words.data() + 4 * (head + i < N ? head + i : head + i - N);
+                }
+
+                void step()
+                {
+                    recursion_scalar(words.data() + 4 * head, (*this)[0], (*this)[POS1], (*this)[N - 2], (*this)[N - 1]);
+                    head = head + 1 < N ? head + 1 : 0;
+                }
+
+                bool low_bit() const { return (*this)[N - 1][0] & 1; }
+
+                window &operator^=(window const &other)
+                {
+                    for (std::size_t i = 0; i < N; i++)
+                    {
+                        std::uint32_t *word = words.data() + 4 * (head + i < N ? head + i : head + i - N);
+                        for (int j = 0; j < 4; j++)
+                        {
+                            word[j] ^= other[i][j];
+                        }
+                    }
+                    return *this;
+                }
+            };
+
+            /*
+             * Characteristic polynomial of the 19968-bit recursion, in steps of one 128-bit word. It is found from
+             *   the output of a generic state, where it has full degree and so annihilates every state; a seeded
+             *   state can miss some components and give only a factor of it.
+             */
+            inline gf2_poly const &polynomial()
+            {
+                static gf2_poly const p = []
+                {
+                    window w;
+                    splitmix64 fill(1);
+                    for (auto &word : w.words)
+                    {
+                        word = static_cast<std::uint32_t>(fill());
+                    }
+                    return gf2_characteristic_polynomial(w, 128 * N);
+                }();
+                return p;
+            }
+
+            /*
+             * Replace the block in state by the one q = x^steps mod p steps of 128-bit words ahead.
+             */
+            inline void jump(std::uint32_t *state, gf2_poly const &q)
+            {
+                window w;
+                std::copy_n(state, N32, w.words.begin());
+                w = gf2_apply(q, w);
+                for (std::size_t i = 0; i < N; i++)
+                {
+                    std::copy_n(w[i], 4, state + 4 * i);
+                }
+            }
+
+        } // namespace sfmt
+
+    } // namespace _detail
+
+    /*
+     * SFMT19937 (Saito & Matsumoto): a Mersenne Twister variant whose recursion works on 128-bit words,
+     *   so the whole 624-word block is regenerated with SSE2 where available. Output matches the reference SFMT
+     *   (init_gen_rand / gen_rand32) but is a different sequence from std::mt19937.
+     *   Besides the per-word interface, fill() writes whole blocks of 32-bit words, 64-bit words or doubles.
+     */
+    class sfmt19937
+    {
+    public:
+        using result_type = std::uint32_t;
+
+        static constexpr result_type default_seed = 5489u;
+        static constexpr std::size_t state_size = _detail::sfmt::N32;
+
+        sfmt19937() : sfmt19937(default_seed) {}
+
+        explicit sfmt19937(std::uint32_t s) { seed(s); }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        explicit sfmt19937(TSeedSeq &seq) { seed(seq); }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        void seed(std::uint32_t s = default_seed)
+        {
+            state[0] = s;
+            for (std::uint32_t i = 1; i < state_size; i++)
+            {
+                state[i] = 1812433253U * (state[i - 1] ^ (state[i - 1] >> 30)) + i;
+            }
+            _detail::sfmt::period_certification(state.data());
+            index = state_size;
+        }
+
+        template <typename TSeedSeq, _detail::enable_if_seed_seq<TSeedSeq> = 0>
+        void seed(TSeedSeq &seq)
+        {
+            seq.generate(state.begin(), state.end());
+            _detail::sfmt::period_certification(state.data());
+            index = state_size;
+        }
+
+        result_type operator()()
+        {
+            if (index >= state_size)
+            {
+                refill();
+            }
+            return state[index++];
+        }
+
+        /*
+         * Skip z outputs: whole blocks at a time for short distances, and the polynomial jump (Haramoto et al. 2008)
+         *   past the current block for long ones, which costs the same however large z is.
+         */
+        void discard(unsigned long long z)
+        {
+            if (z >= jump_threshold)
+            {
+                z -= state_size - std::min(index, state_size);
+                _detail::sfmt::jump(state.data(), _detail::gf2_pow_x_mod(z / state_size * _detail::sfmt::N, _detail::sfmt::polynomial()));
+                index = state_size;
+                z %= state_size;
+            }
+            while (z)
+            {
+                if (index >= state_size)
+                {
+                    refill();
+                }
+                auto step = std::min<unsigned long long>(z, state_size - index);
+                index += static_cast<std::size_t>(step);
+                z -= step;
+            }
+        }
+
+        // Advance by 2^50 blocks (about 2^59 outputs).
+        void long_jump()
+        {
+            static _detail::gf2_poly const q = _detail::gf2_pow_x_mod(_detail::sfmt::N << 50, _detail::sfmt::polynomial());
+            _detail::sfmt::jump(state.data(), q);
+        }
+
+        /*
+         * Write the next n outputs to out, a block at a time. Same values as n calls to operator().
+         */
+        void fill(std::uint32_t *out, std::size_t n)
+        {
+            while (n)
+            {
+                if (index >= state_size)
+                {
+                    refill();
+                }
+                std::size_t count = std::min(n, state_size - index);
+                std::copy_n(state.data() + index, count, out);
+                index += count;
+                out += count;
+                n -= count;
+            }
+        }
+
+        /*
+         * Write n 64-bit words, each made of two consecutive outputs (low word first, as SFMT's gen_rand64).
+         */
+        void fill(std::uint64_t *out, std::size_t n)
+        {
+            fill64(out, n, [](std::uint64_t w) { return w; });
+        }
+
+        /*
+         * Write n doubles uniform on [0, 1), dSFMT-style: 52 random mantissa bits under the exponent of 1.0,
+         *   reinterpreted as a double in [1, 2), minus one. No integer-to-float conversion or multiply per value.
+         */
+        void fill(double *out, std::size_t n)
+        {
+            fill64(out, n, [](std::uint64_t w) { return std::bit_cast<double>((w >> 12) | 0x3FF0000000000000ULL) - 1.0; });
+        }
+
+        // Raw state, two 32-bit words to a 64-bit one, followed by the position in the block.
+        std::array<std::uint64_t, state_size / 2 + 1> state_words() const
+        {
+            std::array<std::uint64_t, state_size / 2 + 1> words;
+            for (std::size_t i = 0; i < state_size / 2; i++)
+            {
+                words[i] = (std::uint64_t(state[2 * i + 1]) << 32) | state[2 * i];
+            }
+            words.back() = index;
+            return words;
+        }
+
+        void set_state_words(std::array<std::uint64_t, state_size / 2 + 1> const &words)
+        {
+            for (std::size_t i = 0; i < state_size / 2; i++)
+            {
+                state[2 * i] = std::uint32_t(words[i]);
+                state[2 * i + 1] = std::uint32_t(words[i] >> 32);
+            }
+            index = static_cast<std::size_t>(std::min<std::uint64_t>(words.back(), state_size));
+        }
+
+        friend bool operator==(sfmt19937 const &lhs, sfmt19937 const &rhs)
+        {
+            return lhs.index == rhs.index && lhs.state == rhs.state;
+        }
+
+    private:
+        // Distances from which discard() jumps instead of regenerating blocks.
+        static constexpr unsigned long long jump_threshold = 1ull << 26;
+
+        void refill()
+        {
+            _detail::sfmt::gen_rand_all(state.data());
+            index = 0;
+        }
+
+        std::uint64_t next64()
+        {
+            std::uint64_t lo = (*this)();
+            return (std::uint64_t((*this)()) << 32) | lo;
+        }
+
+        template <typename T, typename TConvert>
+        void fill64(T *out, std::size_t n, TConvert convert)
+        {
+            while (n)
+            {
+                if (index + 1 >= state_size)
+                {
+                    *out++ = convert(next64());
+                    n--;
+                    continue;
+                }
+                std::size_t count = std::min(n, (state_size - index) / 2);
+                std::uint32_t const *words = state.data() + index;
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    out[i] = convert((std::uint64_t(words[2 * i + 1]) << 32) | words[2 * i]);
+                }
+                index += 2 * count;
+                out += count;
+                n -= count;
+            }
+        }
+
+        alignas(16) std::array<std::uint32_t, state_size> state;
+        std::size_t index;
+    };
+
+    namespace _detail
+    {
+
+        /*
+         * Next 32 or 64 uniformly random bits from any uniform random bit generator.
+         */
+        template <typename TEngine>
+        inline std::uint64_t random_bits64(TEngine &gen)
+        {
+            if constexpr (engine_bits<TEngine> == 64)
+            {
+                return gen();
+            }
+            else if constexpr (engine_bits<TEngine> == 32)
+            {
+                std::uint64_t lo = static_cast<std::uint32_t>(gen());
+                return (std::uint64_t(static_cast<std::uint32_t>(gen())) << 32) | lo;
+            }
+            else
+            {
+                return std::uniform_int_distribution<std::uint64_t>{}(gen);
+            }
+        }
+
+        template <typename TEngine>
+        inline std::uint32_t random_bits32(TEngine &gen)
+        {
+            if constexpr (engine_bits<TEngine> == 32)
+            {
+                return static_cast<std::uint32_t>(gen());
+            }
+            else if constexpr (engine_bits<TEngine> == 64)
+            {
+                return static_cast<std::uint32_t>(gen() >> 32);
+            }
+            else
+            {
+                return std::uniform_int_distribution<std::uint32_t>{}(gen);
+            }
+        }
+
+        /*
+         * Unbiased integer in [0, range) for 0 < range <= 2^32, by Lemire's nearly divisionless method
+         *   ("Fast Random Integer Generation in an Interval", 2019): the high half of a 32x32->64 multiply,
+         *   rejecting the few low halves that would bias it. The modulo only runs when a rejection is possible.
+         */
+        template <typename TEngine>
+        inline std::uint32_t bounded32(TEngine &gen, std::uint32_t range)
+        {
+            std::uint64_t m = std::uint64_t(random_bits32(gen)) * range;
+            std::uint32_t l = static_cast<std::uint32_t>(m);
+            if (l < range)
+            {
+                std::uint32_t t = (0u - range) % range;
+                while (l < t)
+                {
+                    m = std::uint64_t(random_bits32(gen)) * range;
+                    l = static_cast<std::uint32_t>(m);
+                }
+            }
+            return static_cast<std::uint32_t>(m >> 32);
+        }
+
+        /*
+         * Integer types accepted by randrange()/randint()/sample(a, b, k), including __int128 where the compiler has it
+         *   (std::is_integral excludes it in strict ISO mode).
+         */
+        template <typename T>
+        struct is_integer : std::is_integral<T>
+        {
+        };
+
+        template <typename T>
+        struct make_unsigned : std::make_unsigned<T>
+        {
+        };
+
+#ifdef __SIZEOF_INT128__
+        template <>
+        struct is_integer<__int128> : std::true_type
+        {
+        };
+
+        template <>
+        struct is_integer<unsigned __int128> : std::true_type
+        {
+        };
+
+        template <>
+        struct make_unsigned<__int128>
+        {
+            using type = unsigned __int128;
+        };
+
+        template <>
+        struct make_unsigned<unsigned __int128>
+        {
+            using type = unsigned __int128;
+        };
+#endif
+
+        template <typename T>
+        using make_unsigned_t = typename make_unsigned<T>::type;
+
+        template <typename... T>
+        using enable_if_integers = typename std::enable_if<(is_integer<T>::value && ...), int>::type;
+
+        /*
+         * High and low halves of a 64x64->128 multiply.
+         */
+        inline std::uint64_t mul64(std::uint64_t a, std::uint64_t b, std::uint64_t *lo)
+        {
+#ifdef __SIZEOF_INT128__
+            unsigned __int128 m = static_cast<unsigned __int128>(a) * b;
+            *lo = static_cast<std::uint64_t>(m);
+            return static_cast<std::uint64_t>(m >> 64);
+#else
+            std::uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32, b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+            std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+            std::uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+            *lo = (mid << 32) | (ll & 0xFFFFFFFF);
+            return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+        }
+
+        /*
+         * Unbiased integer in [0, range) for 0 < range < 2^64: Lemire's method on a 64x64->128 multiply.
+         */
+        template <typename TEngine>
+        inline std::uint64_t bounded64(TEngine &gen, std::uint64_t range)
+        {
+            std::uint64_t l;
+            std::uint64_t h = mul64(random_bits64(gen), range, &l);
+            if (l < range)
+            {
+                std::uint64_t t = (0 - range) % range;
+                while (l < t)
+                {
+                    h = mul64(random_bits64(gen), range, &l);
+                }
+            }
+            return h;
+        }
+
+#ifdef __SIZEOF_INT128__
+        /*
+         * Unbiased integer in [0, range) for 0 < range < 2^128, by masking to the bit width of range and rejecting.
+         *   Each attempt succeeds with probability above 1/2.
+         */
+        template <typename TEngine>
+        inline unsigned __int128 bounded128(TEngine &gen, unsigned __int128 range)
+        {
+            if (!(range >> 64))
+            {
+                return bounded64(gen, static_cast<std::uint64_t>(range));
+            }
+            unsigned __int128 top = range - 1;
+            int shift = 0;
+            while (top >> (64 + shift))
+            {
+                shift++;
+            }
+            std::uint64_t mask = shift == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << shift) - 1;
+            while (true)
+            {
+                unsigned __int128 hi = random_bits64(gen) & mask;
+                unsigned __int128 x = (hi << 64) | random_bits64(gen);
+                if (x < range)
+                {
+                    return x;
+                }
+            }
+        }
+#endif
+
+        /*
+         * Unbiased integer in [0, range) for any unsigned type, using the narrowest multiply that fits.
+         *   range == 0 stands for the full 2^bits range.
+         */
+        template <typename TUnsigned, typename TEngine>
+        inline TUnsigned bounded(TEngine &gen, TUnsigned range)
+        {
+            if constexpr (sizeof(TUnsigned) <= 4)
+            {
+                if (!range)
+                {
+                    return static_cast<TUnsigned>(random_bits32(gen));
+                }
+                return static_cast<TUnsigned>(bounded32(gen, range));
+            }
+            else if constexpr (sizeof(TUnsigned) <= 8)
+            {
+                if (!range)
+                {
+                    return static_cast<TUnsigned>(random_bits64(gen));
+                }
+                return static_cast<TUnsigned>(bounded64(gen, range));
+            }
+            else
+            {
+#ifdef __SIZEOF_INT128__
+                if (!range)
+                {
+                    return (TUnsigned(random_bits64(gen)) << 64) | random_bits64(gen);
+                }
+                return bounded128(gen, range);
+#endif
+            }
+        }
+
+        /*
+         * Engines whose next word costs about as much as a multiplication. For them a chain of dependent
+         *   multiplications is no cheaper than fresh words, so descending_bounded draws one index at a time.
+         */
+        template <typename TEngine>
+        inline constexpr bool cheap_engine = false;
+
+        template <>
+        inline constexpr bool cheap_engine<splitmix64> = true;
+
+        template <>
+        inline constexpr bool cheap_engine<xoshiro256pp> = true;
+
+        template <>
+        inline constexpr bool cheap_engine<xoshiro128p> = true;
+
+        template <>
+        inline constexpr bool cheap_engine<pcg32> = true;
+
+        template <>
+        inline constexpr bool cheap_engine<sfmt19937> = true;
+
+#ifdef __SIZEOF_INT128__
+        template <>
+        inline constexpr bool cheap_engine<pcg64> = true;
+#endif
+
+        /*
+         * Bounded draws for a Fisher-Yates pass: the t-th call returns a uniform value below first_bound - t.
+         *   Small bounds are batched (Brackett-Rozinsky & Lemire, "Batched Ranged Random Integer Generation", 2024):
+         *   one 64-bit word is split into up to 6 indices by successive multiplications, and the batch is accepted
+         *   or rejected as a whole, like a single Lemire draw below the product of its bounds, so every index stays
+         *   unbiased. Below 2^30 this takes at most half the engine calls of one draw per index, which pays off for
+         *   engines like std::mt19937 whose words cost more than a few multiplications.
+         */
+        class descending_bounded
+        {
+        public:
+            explicit descending_bounded(std::uint64_t first_bound) : bound(first_bound) {}
+
+            template <typename TEngine>
+            std::uint64_t operator()(TEngine &gen)
+            {
+                if (used == ready)
+                {
+                    next(gen);
+                    used = 0;
+                }
+                return batch[used++];
+            }
+
+            /*
+             * The next batch of draws, below the current bound and the ones after it, on their own. Loops that
+             *   consume whole batches avoid the per-call bookkeeping of operator(); don't mix the two.
+             */
+            template <typename TEngine>
+            std::span<std::uint64_t const> next(TEngine &gen)
+            {
+                if (cheap_engine<TEngine> || bound > (1u << 30))
+                {
+                    batch[0] = bound > 0xFFFFFFFFu ? bounded64(gen, bound) : bounded32(gen, static_cast<std::uint32_t>(bound));
+                    ready = 1;
+                }
+                else
+                {
+                    // Batch sizes keep the product of bounds at or below 2^60, so rejections stay rare.
+                    switch (std::min<std::uint64_t>(bound, bound > (1u << 19) ? 2 : bound > (1u << 14) ? 3 : bound > (1u << 11) ? 4 : bound > (1u << 9) ? 5 : 6))
+                    {
+                    case 6:
+                        draw_batch<6>(gen);
+                        break;
+                    case 5:
+                        draw_batch<5>(gen);
+                        break;
+                    case 4:
+                        draw_batch<4>(gen);
+                        break;
+                    case 3:
+                        draw_batch<3>(gen);
+                        break;
+                    case 2:
+                        draw_batch<2>(gen);
+                        break;
+                    default:
+                        draw_batch<1>(gen);
+                        break;
+                    }
+                }
+                bound -= ready;
+                return {batch, ready};
+            }
+
+        private:
+            // A fixed batch size lets the chain of multiplications unroll.
+            template <std::size_t K, typename TEngine>
+            void draw_batch(TEngine &gen)
+            {
+                ready = K;
+                std::uint64_t product = 1;
+                for (std::size_t t = 0; t < K; t++)
+                {
+                    product *= bound - t;
+                }
+                while (true)
+                {
+                    std::uint64_t word = random_bits64(gen);
+                    for (std::size_t t = 0; t < K; t++)
+                    {
+                        std::uint64_t low;
+                        batch[t] = mul64(word, bound - t, &low);
+                        word = low;
+                    }
+                    if (word >= product || word >= (0 - product) % product)
+                    {
+                        return;
+                    }
+                }
+            }
+
+            std::uint64_t bound;
+            std::uint64_t batch[6];
+            std::size_t ready = 0;
+            std::size_t used = 0;
+        };
+
+        /*
+         * Fisher-Yates over a range too large for the cache. Swap targets are drawn shuffle_lookahead steps early,
+         *   in the same order as the plain loop, and prefetched, so several cache misses overlap instead of
+         *   each swap waiting on its own. The permutation is identical to the plain loop's.
+         */
+        inline constexpr std::size_t shuffle_lookahead = 16;
+
+        template <typename TIterator, typename TEngine>
+        inline void shuffle_range_prefetch(TIterator first, std::uint64_t n, TEngine &gen)
+        {
+            descending_bounded targets(n);
+            std::uint64_t ahead[shuffle_lookahead];
+            std::uint64_t i = n - 1;
+            for (std::uint64_t k = 0; k < shuffle_lookahead && k < i; k++)
+            {
+                ahead[(i - k) % shuffle_lookahead] = targets(gen);
+            }
+            for (; i > 0; i--)
+            {
+                std::uint64_t j = ahead[i % shuffle_lookahead];
+                if (i > shuffle_lookahead)
+                {
+                    std::uint64_t later = targets(gen);
+                    ahead[i % shuffle_lookahead] = later;
+                    RANDOMCPP_PREFETCH(std::addressof(first[later]));
+                }
+                std::iter_swap(first + i, first + j);
+            }
+        }
+
+        /*
+         * Fisher-Yates shuffle of a random-access range, with swap targets from descending_bounded.
+         *   Ranges of a megabyte or more take the prefetching loop, which gives the same permutation.
+         */
+        template <typename TIterator, typename TEngine>
+        inline void shuffle_range(TIterator first, TIterator last, TEngine &gen)
+        {
+            using value_type = typename std::iterator_traits<TIterator>::value_type;
+            auto n = last - first;
+            if (n < 2)
+            {
+                return;
+            }
+            if (static_cast<std::uint64_t>(n) * sizeof(value_type) >= (1 << 20))
+            {
+                shuffle_range_prefetch(first, n, gen);
+                return;
+            }
+            descending_bounded targets(n);
+            for (auto i = n - 1; i > 0;)
+            {
+                // The last batch may run on to bound 1, a no-op swap of element 0 with itself.
+                for (auto j : targets.next(gen))
+                {
+                    std::iter_swap(first + i--, first + j);
+                }
+            }
+        }
+
+        inline constexpr std::size_t max_deal_buckets = 64;
+
+        /*
+         * One Rao-Sandelius round: label each of the n elements at source with one of the buckets uniformly at random,
+         *   move them bucket by bucket to target, and return the bucket offsets. A power of two of buckets lets each
+         *   label be a plain slice of bits.
+         */
+        template <typename TSource, typename TTarget, typename TEngine>
+        inline std::array<std::size_t, max_deal_buckets + 1> deal_buckets(TSource source, TTarget target, std::size_t n, std::uint8_t *labels,
+                                                         std::size_t buckets, TEngine &gen)
+        {
+            int label_bits = std::countr_zero(buckets);
+            std::array<std::size_t, max_deal_buckets + 1> offsets{};
+            for (std::size_t i = 0; i < n;)
+            {
+                std::uint64_t bits = random_bits64(gen);
+                for (int used = 0; used + label_bits <= 64 && i < n; used += label_bits, i++)
+                {
+                    labels[i] = static_cast<std::uint8_t>(bits & (buckets - 1));
+                    bits >>= label_bits;
+                    offsets[labels[i] + 1]++;
+                }
+            }
+            for (std::size_t b = 0; b < buckets; b++)
+            {
+                offsets[b + 1] += offsets[b];
+            }
+            std::array<std::size_t, max_deal_buckets> fill;
+            std::copy_n(offsets.begin(), max_deal_buckets, fill.begin());
+            for (std::size_t i = 0; i < n; i++, ++source)
+            {
+                target[fill[labels[i]]++] = std::move(*source);
+            }
+            return offsets;
+        }
+
+        // Few enough buckets that every output stream keeps its page in the first-level TLB.
+        inline std::size_t deal_bucket_count(std::size_t bytes, std::size_t cache_bytes)
+        {
+            return std::clamp<std::size_t>(std::bit_ceil(bytes / cache_bytes), 2, max_deal_buckets);
+        }
+
+        /*
+         * blocked_shuffle() ping-pongs between the range and one scratch buffer, so each level of dealing is a single
+         *   pass: shuffle_in_place() leaves its result where the elements are, shuffle_into() moves them to target.
+         */
+        template <typename TData, typename TSpare, typename TEngine>
+        inline void shuffle_in_place(TData data, TSpare spare, std::size_t n, std::uint8_t *labels, TEngine &gen, std::size_t cache_bytes);
+
+        template <typename TSource, typename TTarget, typename TEngine>
+        inline void shuffle_into(TSource source, TTarget target, std::size_t n, std::uint8_t *labels, TEngine &gen, std::size_t cache_bytes)
+        {
+            using value_type = typename std::iterator_traits<TTarget>::value_type;
+            if (n * sizeof(value_type) <= cache_bytes)
+            {
+                std::move(source, source + n, target);
+                shuffle_range(target, target + n, gen);
+                return;
+            }
+            auto offsets = deal_buckets(source, target, n, labels, deal_bucket_count(n * sizeof(value_type), cache_bytes), gen);
+            for (std::size_t b = 0; offsets[b] < n; b++)
+            {
+                shuffle_in_place(target + offsets[b], source + offsets[b], offsets[b + 1] - offsets[b], labels, gen, cache_bytes);
+            }
+        }
+
+        template <typename TData, typename TSpare, typename TEngine>
+        inline void shuffle_in_place(TData data, TSpare spare, std::size_t n, std::uint8_t *labels, TEngine &gen, std::size_t cache_bytes)
+        {
+            using value_type = typename std::iterator_traits<TData>::value_type;
+            if (n * sizeof(value_type) <= cache_bytes)
+            {
+                shuffle_range(data, data + n, gen);
+                return;
+            }
+            auto offsets = deal_buckets(data, spare, n, labels, deal_bucket_count(n * sizeof(value_type), cache_bytes), gen);
+            for (std::size_t b = 0; offsets[b] < n; b++)
+            {
+                shuffle_into(spare + offsets[b], data + offsets[b], offsets[b + 1] - offsets[b], labels, gen, cache_bytes);
+            }
+        }
+
+        /*
+         * Cache-conscious shuffle (Rao-Sandelius). Every element is dealt to one of up to 64 buckets uniformly at random,
+         *   the buckets are laid out one after another, and each bucket is then shuffled on its own, recursing until
+         *   a bucket fits in cache_bytes. Random bucket sizes make every permutation still equally likely.
+         *   Dealing writes at most 64 sequential streams, so the passes over the data run at memory bandwidth
+         *   rather than paying a cache miss per swap. Uses a scratch copy of the range and one byte per element.
+         */
+        template <typename TIterator, typename TEngine>
+        inline void blocked_shuffle(TIterator first, TIterator last, TEngine &gen, std::size_t cache_bytes = 1 << 18)
+        {
+            using value_type = typename std::iterator_traits<TIterator>::value_type;
+            std::size_t n = last - first;
+            if constexpr (std::is_default_constructible<value_type>::value)
+            {
+                if (n * sizeof(value_type) > cache_bytes)
+                {
+                    std::vector<value_type> scratch(n);
+                    std::vector<std::uint8_t> labels(n);
+                    shuffle_in_place(first, scratch.begin(), n, labels.data(), gen, cache_bytes);
+                    return;
+                }
+            }
+            shuffle_range(first, last, gen);
+        }
+
+        /*
+         * Merge step of MergeShuffle (Bacher, Bodini, Hollender & Lumbroso, "MergeShuffle: a very fast, parallel random
+         *   permutation algorithm", 2015): given [first, mid) and [mid, last) each uniformly shuffled, leave [first, last)
+         *   uniformly shuffled. Coin flips interleave the halves until one runs out, and the leftovers are inserted
+         *   at random positions Fisher-Yates style. Costs about one random bit per element.
+         */
+        template <typename TIterator, typename TEngine>
+        inline void merge_shuffled(TIterator first, TIterator mid, TIterator last, TEngine &gen)
+        {
+            using value_type = typename std::iterator_traits<TIterator>::value_type;
+            auto i = first, j = mid;
+            std::uint64_t bits = 0;
+            int remaining = 0;
+            // While neither half can run out, both coin outcomes advance i, so the swap can be made branch-free.
+            while (i != j && j != last)
+            {
+                if (!remaining)
+                {
+                    bits = random_bits64(gen);
+                    remaining = 64;
+                }
+                std::uint64_t from_right = bits & 1;
+                bits >>= 1;
+                remaining--;
+                if constexpr (std::is_trivially_copyable<value_type>::value && std::has_unique_object_representations<value_type>::value &&
+                              (sizeof(value_type) == 4 || sizeof(value_type) == 8))
+                {
+                    // Masked xor swap: compilers tend to turn a select back into a mispredicted branch.
+                    using word = std::conditional_t<sizeof(value_type) == 4, std::uint32_t, std::uint64_t>;
+                    word left = std::bit_cast<word>(*i), right = std::bit_cast<word>(*j);
+                    word flip = (left ^ right) & (word(0) - static_cast<word>(from_right));
+                    *i = std::bit_cast<value_type>(static_cast<word>(left ^ flip));
+                    *j = std::bit_cast<value_type>(static_cast<word>(right ^ flip));
+                }
+                else if (from_right)
+                {
+                    std::iter_swap(i, j);
+                }
+                j += from_right;
+                ++i;
+            }
+            while (true)
+            {
+                if (!remaining)
+                {
+                    bits = random_bits64(gen);
+                    remaining = 64;
+                }
+                bool from_right = bits & 1;
+                bits >>= 1;
+                remaining--;
+                if (from_right)
+                {
+                    if (j == last)
+                    {
+                        break;
+                    }
+                    std::iter_swap(i, j);
+                    ++j;
+                }
+                else if (i == j)
+                {
+                    break;
+                }
+                ++i;
+            }
+            for (; i != last; ++i)
+            {
+                std::iter_swap(i, first + bounded64(gen, static_cast<std::uint64_t>(i - first) + 1));
+            }
+        }
+
+        /*
+         * Run task(i) for every i in [0, count) on up to `threads` threads (hardware_concurrency() if 0), the calling
+         *   thread included. Indices are handed out from a shared counter; the first exception thrown is rethrown here.
+         */
+        template <typename TTask>
+        inline void parallel_for(std::uint64_t count, unsigned threads, TTask task)
+        {
+            if (!threads)
+            {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            threads = static_cast<unsigned>(std::min<std::uint64_t>(threads, count));
+            if (threads <= 1)
+            {
+                for (std::uint64_t i = 0; i < count; i++)
+                {
+                    task(i);
+                }
+                return;
+            }
+
+            std::atomic<std::uint64_t> next{0};
+            std::vector<std::exception_ptr> errors(threads);
+            auto work = [&](unsigned t)
+            {
+                try
+                {
+                    for (std::uint64_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+                    {
+                        task(i);
+                    }
+                }
+                catch (...)
+                {
+                    errors[t] = std::current_exception();
+                    next = count;
+                }
+            };
+            std::vector<std::thread> pool;
+            for (unsigned t = 1; t < threads; t++)
+            {
+                pool.emplace_back(work, t);
+            }
+            work(0);
+            for (auto &thread : pool)
+            {
+                thread.join();
+            }
+            for (auto &error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        /*
+         * Open-addressing set of indices for Floyd's algorithm: one allocation up front, no per-insert nodes.
+         */
+        class index_set
+        {
+        public:
+            explicit index_set(std::size_t k)
+            {
+                std::size_t capacity = 16;
+                while (capacity < 2 * k)
+                {
+                    capacity *= 2;
+                }
+                slots.assign(capacity, empty);
+                mask = capacity - 1;
+            }
+
+            // Insert value; false if it was already present.
+            bool insert(std::uint64_t value)
+            {
+                std::size_t i = static_cast<std::size_t>((value * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+                while (slots[i] != empty)
+                {
+                    if (slots[i] == value)
+                    {
+                        return false;
+                    }
+                    i = (i + 1) & mask;
+                }
+                slots[i] = value;
+                return true;
+            }
+
+        private:
+            static constexpr std::uint64_t empty = ~std::uint64_t(0);
+            std::vector<std::uint64_t> slots;
+            std::size_t mask;
+        };
+
+        /*
+         * k distinct indices from [0, n), in random order, so every prefix is itself a uniform sample.
+         * - If n <= 4k, a partial Fisher-Yates over a buffer of all n indices (k swaps).
+         * - Otherwise Floyd's algorithm (k draws, never a retry) into an index_set, then a shuffle of the k picks.
+         */
+        template <typename TEngine>
+        inline std::vector<std::uint64_t> sample_indices(TEngine &gen, std::uint64_t n, std::uint64_t k)
+        {
+            if (k > n)
+            {
+                throw std::range_error("sample larger than population");
+            }
+            std::vector<std::uint64_t> picks;
+            if (n <= 4 * k)
+            {
+                picks.resize(static_cast<std::size_t>(n));
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    picks[i] = i;
+                }
+                descending_bounded targets(n);
+                for (std::uint64_t i = 0; i < k; i++)
+                {
+                    std::uint64_t j = i + targets(gen);
+                    std::swap(picks[i], picks[j]);
+                }
+                picks.resize(static_cast<std::size_t>(k));
+                return picks;
+            }
+
+            picks.reserve(static_cast<std::size_t>(k));
+            index_set selected(static_cast<std::size_t>(k));
+            for (std::uint64_t i = n - k; i < n; i++)
+            {
+                std::uint64_t j = bounded(gen, i + 1);
+                if (!selected.insert(j))
+                {
+                    j = i;
+                    selected.insert(i);
+                }
+                picks.push_back(j);
+            }
+            shuffle_range(picks.begin(), picks.end(), gen);
+            return picks;
+        }
+
+        /*
+         * Visit the elements of population at the given indices, in a single forward traversal.
+         *   visit(slot, itr) is called with each index's position in `indices` and an iterator to its element.
+         *   Random-access populations are indexed directly; others are walked once over the sorted indices,
+         *   instead of being re-walked from begin() for every pick.
+         */
+        template <typename TContainer, typename TVisit>
+        inline void visit_indices(TContainer const &population, std::vector<std::uint64_t> const &indices, TVisit visit)
+        {
+            using iterator_category = typename std::iterator_traits<decltype(population.begin())>::iterator_category;
+            if constexpr (std::is_base_of<std::random_access_iterator_tag, iterator_category>::value)
+            {
+                for (std::size_t slot = 0; slot < indices.size(); slot++)
+                {
+                    visit(slot, population.begin() + indices[slot]);
+                }
+            }
+            else
+            {
+                std::vector<std::pair<std::uint64_t, std::size_t>> order;
+                order.reserve(indices.size());
+                for (std::size_t slot = 0; slot < indices.size(); slot++)
+                {
+                    order.emplace_back(indices[slot], slot);
+                }
+                std::sort(order.begin(), order.end());
+                auto itr = population.begin();
+                std::uint64_t position = 0;
+                for (auto const &[index, slot] : order)
+                {
+                    std::advance(itr, index - position);
+                    position = index;
+                    visit(slot, itr);
+                }
+            }
+        }
+
+        // Doubles on [0, 1) and (0, 1) from the top 53 bits of a word.
+        template <typename TEngine>
+        inline double uniform01(TEngine &gen)
+        {
+            return to_double(random_bits64(gen));
+        }
+
+        template <typename TEngine>
+        inline double open01(TEngine &gen)
+        {
+            return (static_cast<double>(random_bits64(gen) >> 11) + 0.5) * 0x1.0p-53;
+        }
+
+        /*
+         * A TReal in [0, 1): the top 24 bits of one 32-bit word for float, the top 53 bits of a 64-bit word for double,
+         *   and a whole 64-bit word for a long double with a 64-bit significand (a double elsewhere).
+         */
+        template <typename TReal, typename TEngine>
+        inline TReal uniform_real(TEngine &gen)
+        {
+            static_assert(std::is_floating_point_v<TReal>, "uniform_real<TReal>() needs a floating point type");
+            if constexpr (std::is_same_v<TReal, float>)
+            {
+                return to_float(random_bits32(gen));
+            }
+            else if constexpr (std::numeric_limits<TReal>::digits >= 64)
+            {
+                return static_cast<TReal>(random_bits64(gen)) * static_cast<TReal>(0x1.0p-64L);
+            }
+            else
+            {
+                return to_double(random_bits64(gen));
+            }
+        }
+
+        /*
+         * Box-Muller transform of two 64-bit words into the pair (cosine, sine) of Gaussian variates.
+         *   The radius uniform takes 53 bits at every precision, so the tails reach about 8.6 sigma.
+         */
+        template <typename TReal>
+        inline std::pair<TReal, TReal> box_muller(std::uint64_t radius_bits, std::uint64_t angle_bits, TReal mu, TReal sigma)
+        {
+            // 1 - u lies in (0, 1], so the log is finite.
+            TReal radius = sigma * static_cast<TReal>(std::sqrt(-2 * std::log(1 - to_double(radius_bits))));
+            TReal theta = static_cast<TReal>(2 * std::numbers::pi * to_double(angle_bits));
+            return {mu + radius * std::cos(theta), mu + radius * std::sin(theta)};
+        }
+
+        /*
+         * Ziggurat tables (Marsaglia & Tsang, "The Ziggurat Method for Generating Random Variables", 2000),
+         *   256 layers of equal area v under a decreasing density f, the bottom one carrying the tail beyond r.
+         *   A draw takes 8 bits for the layer and 52 bits for the abscissa, so the layer index and the value
+         *   never share bits (Doornik's fix for the original 32-bit version).
+         */
+        struct ziggurat_table
+        {
+            static constexpr int layers = 256;
+            static constexpr double scale = 0x1.0p52;
+
+            double r;
+            std::array<std::uint64_t, layers> k; // acceptance thresholds for the inner rectangle
+            std::array<double, layers> w;        // abscissa per unit of the 52-bit integer
+            std::array<double, layers> f;        // density at each layer edge
+
+            template <typename TDensity, typename TInverse>
+            ziggurat_table(double r_, double v, TDensity density, TInverse inverse) : r(r_)
+            {
+                double x = r, prev = r;
+                double q = v / density(r);
+                k[0] = static_cast<std::uint64_t>((r / q) * scale);
+                k[1] = 0;
+                w[0] = q / scale;
+                w[layers - 1] = r / scale;
+                f[0] = 1.0;
+                f[layers - 1] = density(r);
+                for (int i = layers - 2; i >= 1; i--)
+                {
+                    x = inverse(v / x + density(x));
+                    k[i + 1] = static_cast<std::uint64_t>((x / prev) * scale);
+                    prev = x;
+                    f[i] = density(x);
+                    w[i] = x / scale;
+                }
+            }
+        };
+
+        inline ziggurat_table const &normal_table()
+        {
+            static ziggurat_table const table(
+                3.6541528853610088, 4.92867323399e-3,
+                [](double x) { return std::exp(-0.5 * x * x); },
+                [](double y) { return std::sqrt(-2.0 * std::log(y)); });
+            return table;
+        }
+
+        inline ziggurat_table const &exponential_table()
+        {
+            static ziggurat_table const table(
+                7.69711747013104972, 3.949659822581572e-3,
+                [](double x) { return std::exp(-x); },
+                [](double y) { return -std::log(y); });
+            return table;
+        }
+
+        /*
+         * Standard normal variate starting from the 64 random bits in `bits`.
+         *   About 99% of draws return from the first comparison; the rest retry with fresh bits from gen.
+         */
+        template <typename TEngine>
+        inline double normal_ziggurat(std::uint64_t bits, TEngine &gen)
+        {
+            auto const &t = normal_table();
+            while (true)
+            {
+                unsigned i = bits & 0xff;
+                bool negative = (bits >> 8) & 1;
+                std::uint64_t u = (bits >> 9) & ((std::uint64_t(1) << 52) - 1);
+                double x = static_cast<double>(u) * t.w[i];
+                if (u < t.k[i])
+                {
+                    return negative ? -x : x;
+                }
+                if (i == 0)
+                {
+                    // Tail beyond r (Marsaglia, 1964).
+                    double xx, yy;
+                    do
+                    {
+                        xx = -std::log(open01(gen)) / t.r;
+                        yy = -std::log(open01(gen));
+                    } while (yy + yy < xx * xx);
+                    return negative ? -(t.r + xx) : t.r + xx;
+                }
+                if (t.f[i] + uniform01(gen) * (t.f[i - 1] - t.f[i]) < std::exp(-0.5 * x * x))
+                {
+                    return negative ? -x : x;
+                }
+                bits = random_bits64(gen);
+            }
+        }
+
+        /*
+         * Standard exponential variate starting from the 64 random bits in `bits`.
+         */
+        template <typename TEngine>
+        inline double exponential_ziggurat(std::uint64_t bits, TEngine &gen)
+        {
+            auto const &t = exponential_table();
+            while (true)
+            {
+                unsigned i = bits & 0xff;
+                std::uint64_t u = (bits >> 8) & ((std::uint64_t(1) << 52) - 1);
+                double x = static_cast<double>(u) * t.w[i];
+                if (u < t.k[i])
+                {
+                    return x;
+                }
+                if (i == 0)
+                {
+                    // The exponential is memoryless, so the tail is just r plus a fresh variate.
+                    return t.r - std::log(open01(gen));
+                }
+                if (t.f[i] + uniform01(gen) * (t.f[i - 1] - t.f[i]) < std::exp(-x))
+                {
+                    return x;
+                }
+                bits = random_bits64(gen);
+            }
+        }
+
+        /*
+         * Top-k exponential keys for weighted sampling without replacement (Efraimidis & Spirakis, "Weighted random
+         *   sampling with a reservoir", 2006). Item i gets key u^(1/w_i) and the k largest keys win; ranked by key, they
+         *   come out in the order successive weighted draws would have picked them. Keys are kept as log(u) / w so tiny
+         *   weights do not underflow, in a min-heap bounded at k entries.
+         *   Once the heap is full, A-ExpJ jumps over an exponentially distributed amount of weight instead of keying
+         *   every item, so n items cost O(k log(n / k)) random draws rather than n.
+         */
+        template <typename TPayload>
+        class weighted_keys
+        {
+        public:
+            explicit weighted_keys(std::size_t k_) : k(k_)
+            {
+                heap.reserve(k);
+            }
+
+            template <typename TEngine>
+            void offer(TEngine &gen, double w, TPayload const &payload)
+            {
+                if (!(w >= 0.0) || !std::isfinite(w))
+                {
+                    throw std::invalid_argument("Weights must be finite and non-negative");
+                }
+                if (w == 0.0)
+                {
+                    return;
+                }
+                if (heap.size() < k)
+                {
+                    heap.emplace_back(std::log(open01(gen)) / w, payload);
+                    std::push_heap(heap.begin(), heap.end(), later);
+                    return;
+                }
+                if (std::isnan(jump))
+                {
+                    jump = next_jump(gen);
+                }
+                jump -= w;
+                if (jump > 0.0)
+                {
+                    return;
+                }
+                // The new key is conditioned to beat the threshold: u is uniform on (threshold^w, 1).
+                double t = std::exp(w * heap.front().first);
+                double key = std::log(t + (1.0 - t) * open01(gen)) / w;
+                std::pop_heap(heap.begin(), heap.end(), later);
+                heap.back() = {key, payload};
+                std::push_heap(heap.begin(), heap.end(), later);
+                jump = next_jump(gen);
+            }
+
+            /*
+             * Keep the k largest keys of both sides. Keys are exact, so this is the top-k of the combined input.
+             */
+            void merge(weighted_keys const &other)
+            {
+                heap.insert(heap.end(), other.heap.begin(), other.heap.end());
+                if (heap.size() > k)
+                {
+                    std::nth_element(heap.begin(), heap.begin() + k, heap.end(), later);
+                    heap.resize(k);
+                }
+                std::make_heap(heap.begin(), heap.end(), later);
+                // The jump depended on the old threshold; draw a fresh one on the next offer (jumps are memoryless).
+                jump = std::numeric_limits<double>::quiet_NaN();
+            }
+
+            std::size_t size() const { return heap.size(); }
+
+            // Payloads by decreasing key, i.e. in draw order.
+            std::vector<TPayload> ranked() const
+            {
+                auto sorted(heap);
+                std::sort_heap(sorted.begin(), sorted.end(), later);
+                std::vector<TPayload> result;
+                result.reserve(sorted.size());
+                for (auto &entry : sorted)
+                {
+                    result.push_back(std::move(entry.second));
+                }
+                return result;
+            }
+
+        private:
+            static bool later(std::pair<double, TPayload> const &lhs, std::pair<double, TPayload> const &rhs)
+            {
+                return lhs.first > rhs.first;
+            }
+
+            // Weight to pass over before the next replacement: log(r) / log(threshold) in the original formulation.
+            template <typename TEngine>
+            double next_jump(TEngine &gen) const
+            {
+                double threshold = heap.front().first;
+                return threshold < 0.0 ? std::log(open01(gen)) / threshold : std::numeric_limits<double>::infinity();
+            }
+
+            std::size_t k;
+            std::vector<std::pair<double, TPayload>> heap;
+            double jump = std::numeric_limits<double>::quiet_NaN();
+        };
+
+    } // namespace _detail
+
+    /*
+     * Tag selecting the Ziggurat algorithm in gauss(), normalvariate() and expovariate().
+     */
+    struct ziggurat_t
+    {
+        explicit ziggurat_t() = default;
+    };
+
+    inline constexpr ziggurat_t ziggurat{};
+
+    /*
+     * Tag selecting the cache-conscious bucketed algorithm in shuffle(), for ranges much larger than the cache.
+     */
+    struct cache_blocked_t
+    {
+        explicit cache_blocked_t() = default;
+    };
+
+    inline constexpr cache_blocked_t cache_blocked{};
+
+    /*
+     * Tag marking the weights passed to choices() as cumulative, like Python's cum_weights= keyword.
+     */
+    struct cum_weights_t
+    {
+        explicit cum_weights_t() = default;
+    };
+
+    inline constexpr cum_weights_t cum_weights{};
+
+    /*
+     * Walker's alias table, built with Vose's O(n) method ("A linear algorithm for generating random numbers
+     *   with a given distribution", 1991). Once built for a fixed weight vector, each draw costs one 64-bit word,
+     *   one multiply and one compare, whatever the number of outcomes.
+     */
+    class AliasTable
+    {
+    public:
+        template <typename TWeights>
+        explicit AliasTable(TWeights const &weights)
+        {
+            std::size_t n = std::distance(std::begin(weights), std::end(weights));
+            if (!n)
+            {
+                throw std::invalid_argument("AliasTable: weights must not be empty");
+            }
+            double total = 0.0;
+            for (auto weight : weights)
+            {
+                if (!(weight >= 0.0))
+                {
+                    throw std::invalid_argument("AliasTable: weights must be non-negative");
+                }
+                total += weight;
+            }
+            if (!(total > 0.0) || !std::isfinite(total))
+            {
+                throw std::invalid_argument("AliasTable: total of weights must be finite and greater than zero");
+            }
+
+            std::vector<double> scaled;
+            scaled.reserve(n);
+            for (auto weight : weights)
+            {
+                scaled.push_back(static_cast<double>(weight) * n / total);
+            }
+            threshold.assign(n, ~std::uint64_t(0));
+            alias.resize(n);
+            std::vector<std::size_t> small, large;
+            for (std::size_t i = 0; i < n; i++)
+            {
+                alias[i] = i;
+                (scaled[i] < 1.0 ? small : large).push_back(i);
+            }
+            while (!small.empty() && !large.empty())
+            {
+                std::size_t s = small.back(), l = large.back();
+                small.pop_back();
+                threshold[s] = static_cast<std::uint64_t>(std::ldexp(scaled[s], 64));
+                alias[s] = l;
+                scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+                if (scaled[l] < 1.0)
+                {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+            // Whatever is left is 1 up to rounding and keeps its own column (alias[i] == i).
+        }
+
+        std::size_t size() const { return alias.size(); }
+
+        /*
+         * Draw one index. The column comes from the high half of word * n (unbiased, as in Lemire's method) and the
+         *   low half is the coin for that column, with 64 - log2(n) bits of resolution.
+         */
+        template <typename TEngine>
+        std::size_t operator()(TEngine &gen) const
+        {
+            std::uint64_t n = alias.size(), l;
+            std::uint64_t column = _detail::mul64(_detail::random_bits64(gen), n, &l);
+            if (l < n)
+            {
+                std::uint64_t t = (0 - n) % n;
+                while (l < t)
+                {
+                    column = _detail::mul64(_detail::random_bits64(gen), n, &l);
+                }
+            }
+            return l < threshold[column] ? column : alias[column];
+        }
+
+        /*
+         * Fill out with independent draws.
+         */
+        template <typename TEngine>
+        void operator()(TEngine &gen, std::span<std::size_t> out) const
+        {
+            for (auto &index : out)
+            {
+                index = (*this)(gen);
+            }
+        }
+
+    private:
+        std::vector<std::uint64_t> threshold; // keep the column if the coin is below this, else take its alias
+        std::vector<std::size_t> alias;
+    };
+
+    /*
+     * Weighted index sampler for weights that keep changing between draws.
+     *   The weights sit in the leaves of a flat binary sum tree. update(), insert() and erase() refresh one
+     *   leaf-to-root path in O(log n), and a draw walks from the root down to a leaf in O(log n), so nothing is
+     *   rebuilt after each change. Each parent is recomputed from its two children rather than adjusted by a delta,
+     *   so rounding error does not build up over long runs of updates.
+     *   Indices stay valid until erased, and insert() reuses erased indices before growing the tree.
+     *   Erased slots carry weight 0 and are never drawn.
+     */
+    class DynamicWeightedSampler
+    {
+    public:
+        DynamicWeightedSampler() : tree(2, 0.0) {}
+
+        template <typename TWeights>
+        explicit DynamicWeightedSampler(TWeights const &weights) : DynamicWeightedSampler()
+        {
+            std::size_t n = std::distance(std::begin(weights), std::end(weights));
+            reserve(n);
+            for (auto weight : weights)
+            {
+                tree[leaves + slots++] = check_weight(weight);
+            }
+            live.assign(slots, true);
+            for (std::size_t node = leaves - 1; node > 0; node--)
+            {
+                tree[node] = tree[2 * node] + tree[2 * node + 1];
+            }
+        }
+
+        /*
+         * Number of indices handed out so far, erased or not; every valid index is below it.
+         */
+        std::size_t size() const { return slots; }
+
+        double weight(std::size_t i) const
+        {
+            check_index(i);
+            return tree[leaves + i];
+        }
+
+        double total() const { return tree[1]; }
+
+        /*
+         * Set the weight of index i. Raises out_of_range for an index that was never inserted or has been erased.
+         */
+        void update(std::size_t i, double w)
+        {
+            check_index(i);
+            set(i, check_weight(w));
+        }
+
+        /*
+         * Add an entry with weight w and return its index, reusing the most recently erased index if there is one.
+         */
+        std::size_t insert(double w)
+        {
+            check_weight(w);
+            std::size_t i;
+            if (!free_slots.empty())
+            {
+                i = free_slots.back();
+                free_slots.pop_back();
+                live[i] = true;
+            }
+            else
+            {
+                reserve(slots + 1);
+                i = slots++;
+                live.push_back(true);
+            }
+            set(i, w);
+            return i;
+        }
+
+        void erase(std::size_t i)
+        {
+            check_index(i);
+            set(i, 0.0);
+            live[i] = false;
+            free_slots.push_back(i);
+        }
+
+        /*
+         * Draw one index with probability weight(i) / total(). Raises logic_error if the total weight is zero.
+         */
+        template <typename TEngine>
+        std::size_t operator()(TEngine &gen) const
+        {
+            if (!(tree[1] > 0.0))
+            {
+                throw std::logic_error("Cannot sample when the total of weights is zero");
+            }
+            double u = _detail::uniform01(gen) * tree[1];
+            std::size_t node = 1;
+            while (node < leaves)
+            {
+                node *= 2;
+                // Going right past a zero-weight subtree can only be rounding error at the top end, so stay left.
+                if (u >= tree[node] && tree[node + 1] > 0.0)
+                {
+                    u -= tree[node];
+                    node++;
+                }
+            }
+            return node - leaves;
+        }
+
+        /*
+         * Fill out with independent draws.
+         */
+        template <typename TEngine>
+        void operator()(TEngine &gen, std::span<std::size_t> out) const
+        {
+            for (auto &index : out)
+            {
+                index = (*this)(gen);
+            }
+        }
+
+    private:
+        static double check_weight(double w)
+        {
+            if (!(w >= 0.0) || !std::isfinite(w))
+            {
+                throw std::invalid_argument("DynamicWeightedSampler: weights must be finite and non-negative");
+            }
+            return w;
+        }
+
+        void check_index(std::size_t i) const
+        {
+            if (i >= slots || !live[i])
+            {
+                throw std::out_of_range("DynamicWeightedSampler: no entry at this index");
+            }
+        }
+
+        void set(std::size_t i, double w)
+        {
+            std::size_t node = leaves + i;
+            tree[node] = w;
+            for (node /= 2; node > 0; node /= 2)
+            {
+                tree[node] = tree[2 * node] + tree[2 * node + 1];
+            }
+        }
+
+        // Grow the leaf row to a power of two holding at least n entries, rebuilding the tree (amortized O(1) per insert).
+        void reserve(std::size_t n)
+        {
+            if (n <= leaves)
+            {
+                return;
+            }
+            std::size_t grown = std::bit_ceil(n);
+            std::vector<double> rebuilt(2 * grown, 0.0);
+            std::copy(tree.begin() + leaves, tree.begin() + leaves + slots, rebuilt.begin() + grown);
+            for (std::size_t node = grown - 1; node > 0; node--)
+            {
+                rebuilt[node] = rebuilt[2 * node] + rebuilt[2 * node + 1];
+            }
+            tree.swap(rebuilt);
+            leaves = grown;
+        }
+
+        std::vector<double> tree;  // tree[1] is the root, tree[leaves + i] the weight of index i
+        std::size_t leaves = 1;
+        std::size_t slots = 0;
+        std::vector<bool> live;
+        std::vector<std::size_t> free_slots;
+    };
+
+    namespace _detail
+    {
+
+        /*
+         * Whether an engine exposes its raw state as state_words()/set_state_words() (the engines in this header do).
+         */
+        template <typename TEngine>
+        struct has_state_words
+        {
+        private:
+            template <typename U>
+            static auto Test(int) -> decltype(std::declval<U const &>().state_words(), std::true_type{});
+
+            template <typename U>
+            static std::false_type Test(...);
+
+        public:
+            static constexpr bool value = decltype(Test<TEngine>(0))::value;
+        };
+
+        /*
+         * Whether an engine has a long_jump() of its own (the engines in this header do).
+         */
+        template <typename TEngine>
+        struct has_long_jump
+        {
+        private:
+            template <typename U>
+            static auto Test(int) -> decltype(std::declval<U &>().long_jump(), std::true_type{});
+
+            template <typename U>
+            static std::false_type Test(...);
+
+        public:
+            static constexpr bool value = decltype(Test<TEngine>(0))::value;
+        };
+
+        /*
+         * getstate() blob layout, version 1, every field little-endian:
+         *   0  "RC" magic          4  word width (4 or 8)   8  seed (u32)        16 stream id (u64)
+         *   2  version             5  reserved, zero        12 word count (u32)  24 engine words
+         *   3  engine tag
+         *   Engines from this header store their raw state words; standard engines store the integers of their
+         *   textual representation, which restores exactly on the same standard library.
+         */
+        inline constexpr std::uint8_t state_version = 1;
+        inline constexpr std::size_t state_header = 24;
+
+        template <typename TEngine>
+        inline constexpr std::uint8_t engine_tag = 0;
+
+        template <>
+        inline constexpr std::uint8_t engine_tag<splitmix64> = 1;
+
+        template <>
+        inline constexpr std::uint8_t engine_tag<xoshiro256pp> = 2;
+
+        template <>
+        inline constexpr std::uint8_t engine_tag<xoshiro128p> = 3;
+
+        template <>
+        inline constexpr std::uint8_t engine_tag<pcg32> = 4;
+
+#ifdef __SIZEOF_INT128__
+        template <>
+        inline constexpr std::uint8_t engine_tag<pcg64> = 5;
+#endif
+
+        template <>
+        inline constexpr std::uint8_t engine_tag<philox4x32> = 6;
+
+        template <>
+        inline constexpr std::uint8_t engine_tag<sfmt19937> = 7;
+
+        template <>
+        inline constexpr std::uint8_t engine_tag<std::mt19937> = 16;
+
+        template <>
+        inline constexpr std::uint8_t engine_tag<std::mt19937_64> = 17;
+
+        inline void store_le(std::uint8_t *out, std::uint64_t value, std::size_t bytes)
+        {
+            for (std::size_t i = 0; i < bytes; i++)
+            {
+                out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+            }
+        }
+
+        inline std::uint64_t load_le(std::uint8_t const *in, std::size_t bytes)
+        {
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < bytes; i++)
+            {
+                value |= std::uint64_t(in[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        template <typename TEngine>
+        inline std::vector<std::uint64_t> save_engine(TEngine const &gen)
+        {
+            if constexpr (has_state_words<TEngine>::value)
+            {
+                auto words = gen.state_words();
+                return std::vector<std::uint64_t>(words.begin(), words.end());
+            }
+            else
+            {
+                std::stringstream stream;
+                stream.imbue(std::locale::classic());
+                stream << gen;
+                std::vector<std::uint64_t> words;
+                for (unsigned long long token; stream >> token;)
+                {
+                    words.push_back(token);
+                }
+                return words;
+            }
+        }
+
+        template <typename TEngine>
+        inline void load_engine(TEngine *gen, std::vector<std::uint64_t> const &words)
+        {
+            if constexpr (has_state_words<TEngine>::value)
+            {
+                decltype(gen->state_words()) state{};
+                if (words.size() != state.size())
+                {
+                    throw std::invalid_argument("setstate(): wrong state size for this engine");
+                }
+                std::copy(words.begin(), words.end(), state.begin());
+                gen->set_state_words(state);
+            }
+            else
+            {
+                std::stringstream stream;
+                stream.imbue(std::locale::classic());
+                for (auto word : words)
+                {
+                    stream << word << ' ';
+                }
+                TEngine loaded;
+                if (!(stream >> loaded))
+                {
+                    throw std::invalid_argument("setstate(): wrong state size for this engine");
+                }
+                *gen = loaded;
+            }
+        }
+
+    } // namespace _detail
+
+    // Distribution objects, defined after BasicRandom with the other distributions.
+    template <typename TReal = float>
+    class GammaDist;
+
+    template <typename TReal = float>
+    class BetaDist;
+
+    template <typename TReal = float>
+    class VonMisesDist;
+
+    template <typename TReal = float>
+    class ParetoDist;
+
+    template <typename TReal = float>
+    class WeibullDist;
+
+    template <typename TReal = float>
+    class DirichletDist;
+
+    /*
+     * Random number generator with its own engine and seed, like Python's random.Random.
+     *   Instances share no state, so each thread (or simulation shard) can own one and draw from it without locking.
+     *   TEngine is any uniform random bit generator that can be seeded from an integer or a seed sequence,
+     *   e.g. std::mt19937 (the default, for reproducibility), xoshiro256pp or pcg32.
+     *   The module-level functions below are bound to a default instance.
+     */
+    template <typename TEngine = std::mt19937>
+    class BasicRandom
+    {
+    public:
+        using engine_type = TEngine;
+        using result_type = typename engine_type::result_type;
+
+        BasicRandom() : seed_value(0), gen(seed_value) {}
+
+        explicit BasicRandom(unsigned a) : seed_value(a), gen(seed_value) {}
+
+        /*
+         * Seed with a and select one of several independent streams for that seed.
+         *   Stream 0 is the plain seed(a) sequence; other streams mix the stream id into the engine's seed sequence.
+         */
+        BasicRandom(unsigned a, std::uint64_t stream) : seed_value(a), stream_id(stream)
+        {
+            initialize();
+        }
+
+        // A BasicRandom is itself a uniform random bit generator, so it can be handed to <random> and <algorithm>.
+        static constexpr result_type min() { return engine_type::min(); }
+        static constexpr result_type max() { return engine_type::max(); }
+        result_type operator()() { return gen(); }
+
+        engine_type &engine() { return gen; }
+
+        // Bookkeeping functions:
+        /*
+         * Initialize the random number generator.
+         *    If a is omitted or None, the current system time is used.
+         *    If a is an int, it is used directly.
+         */
+        void seed(unsigned a)
+        {
+            seed_value = a;
+            initialize();
+        }
+
+        void seed(unsigned a, std::uint64_t stream)
+        {
+            seed_value = a;
+            stream_id = stream;
+            initialize();
+        }
+
+        void seed()
+        {
+            seed(static_cast<unsigned>(std::time(0)));
+        }
+
+        /*
+         * Reseed the random generator with the stored seed.
+         */
+        void reset()
+        {
+            initialize();
+        }
+
+        /*
+         * Return an object capturing the current internal state of the generator: a compact, versioned,
+         *   little-endian byte string (see _detail::state_header) that can be stored in a file and later passed
+         *   to setstate() to continue from exactly this point, with no replay of earlier draws.
+         */
+        std::vector<std::uint8_t> getstate() const
+        {
+            std::vector<std::uint64_t> words = _detail::save_engine(gen);
+            std::size_t width = 4;
+            for (auto word : words)
+            {
+                width = word >> 32 ? 8 : width;
+            }
+
+            std::vector<std::uint8_t> state(_detail::state_header + width * words.size(), 0);
+            state[0] = 'R';
+            state[1] = 'C';
+            state[2] = _detail::state_version;
+            state[3] = _detail::engine_tag<engine_type>;
+            state[4] = static_cast<std::uint8_t>(width);
+            _detail::store_le(&state[8], seed_value, 4);
+            _detail::store_le(&state[12], words.size(), 4);
+            _detail::store_le(&state[16], stream_id, 8);
+            for (std::size_t i = 0; i < words.size(); i++)
+            {
+                _detail::store_le(&state[_detail::state_header + width * i], words[i], width);
+            }
+            return state;
+        }
+
+        /*
+         * Restore the internal state of the generator from what getstate() returned, e.g. a view of a memory-mapped file.
+         *   Raises invalid_argument if state is not a getstate() blob for this engine type.
+         */
+        void setstate(std::span<std::uint8_t const> state)
+        {
+            if (state.size() < _detail::state_header || state[0] != 'R' || state[1] != 'C')
+            {
+                throw std::invalid_argument("setstate(): not a randomcpp state");
+            }
+            if (state[2] != _detail::state_version)
+            {
+                throw std::invalid_argument("setstate(): unsupported state version");
+            }
+            std::size_t width = state[4];
+            std::size_t count = static_cast<std::size_t>(_detail::load_le(&state[12], 4));
+            if (state[3] != _detail::engine_tag<engine_type> || (width != 4 && width != 8) ||
+                state.size() != _detail::state_header + width * count)
+            {
+                throw std::invalid_argument("setstate(): state was saved from a different engine");
+            }
+
+            std::vector<std::uint64_t> words(count);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                words[i] = _detail::load_le(&state[_detail::state_header + width * i], width);
+            }
+            _detail::load_engine(&gen, words);
+            seed_value = static_cast<unsigned>(_detail::load_le(&state[8], 4));
+            stream_id = _detail::load_le(&state[16], 8);
+        }
+
+        /*
+         * Advance the generator as if n engine outputs had been drawn and discarded, using the engine's discard():
+         *   O(log n) for splitmix64, pcg32, pcg64, philox4x32 and the xoshiro engines, and a polynomial jump
+         *   (Haramoto et al. 2008) for long distances on sfmt19937. For std::mersenne_twister_engine (std::mt19937,
+         *   std::mt19937_64), whose discard() is O(n), distances of 2^20 and more use the polynomial jump too;
+         *   its cost does not grow with n. Other standard engines step through their O(n) discard().
+         *   n counts engine outputs, not calls: most functions here draw a varying number of outputs per call.
+         */
+        void jump(unsigned long long n)
+        {
+            if constexpr (_detail::is_mersenne_twister<engine_type>::value)
+            {
+                _detail::mt_jump(&gen, n);
+            }
+            else
+            {
+                gen.discard(n);
+            }
+        }
+
+        /*
+         * Advance by a fixed distance long enough that no realistic run reaches the next substream:
+         *   2^64 outputs for std::mersenne_twister_engine, and the engine's own long_jump() otherwise.
+         *   Engines with neither, such as std::minstd_rand, cannot be split into substreams this way.
+         */
+        void long_jump()
+        {
+            if constexpr (_detail::is_mersenne_twister<engine_type>::value)
+            {
+                _detail::mt_jump(&gen, _detail::mt_long_jump<engine_type>());
+            }
+            else
+            {
+                static_assert(_detail::has_long_jump<engine_type>::value,
+                              "long_jump() and split(k) need an engine with long_jump() or a std::mersenne_twister_engine");
+                gen.long_jump();
+            }
+        }
+
+        /*
+         * Return k generators on non-overlapping substreams: the i-th starts i long jumps ahead of this one,
+         *   which then moves past all of them. Hand one to each thread or process.
+         */
+        std::vector<BasicRandom> split(std::size_t k)
+        {
+            std::vector<BasicRandom> streams;
+            streams.reserve(k);
+            for (std::size_t i = 0; i < k; i++)
+            {
+                streams.push_back(*this);
+                long_jump();
+            }
+            return streams;
+        }
+
+        /*
+         * Return k generators over consecutive blocks of n engine outputs of this generator's sequence,
+         *   which then moves past all of them. Worker i drawing its n outputs reproduces outputs i*n..(i+1)*n-1
+         *   of the single-threaded run exactly.
+         */
+        std::vector<BasicRandom> split(std::size_t k, unsigned long long n)
+        {
+            std::vector<BasicRandom> streams;
+            streams.reserve(k);
+            if constexpr (_detail::is_mersenne_twister<engine_type>::value)
+            {
+                if (n >= _detail::mt_jump_threshold)
+                {
+                    _detail::gf2_poly q = _detail::gf2_pow_x_mod(n - engine_type::state_size - 1, _detail::mt_polynomial<engine_type>());
+                    for (std::size_t i = 0; i < k; i++)
+                    {
+                        streams.push_back(*this);
+                        _detail::mt_jump(&gen, q);
+                    }
+                    return streams;
+                }
+            }
+            for (std::size_t i = 0; i < k; i++)
+            {
+                streams.push_back(*this);
+                jump(n);
+            }
+            return streams;
+        }
+
+        // Functions for integers:
+        //   These accept any integer type (int64_t, uint64_t, and __int128 where available); mixed argument types use
+        //   their common type. Widths are computed in the unsigned type, so ranges like [INT64_MIN, INT64_MAX] don't overflow.
+        /*
+         * Return a random integer in the range [0, n). Raises range_error if n <= 0.
+         */
+        template <typename TInt, _detail::enable_if_integers<TInt> = 0>
+        TInt _randbelow(TInt n)
+        {
+            if (n <= 0)
+            {
+                throw std::range_error("empty range for _randbelow()");
+            }
+            using TUnsigned = _detail::make_unsigned_t<TInt>;
+            return static_cast<TInt>(_detail::bounded(gen, static_cast<TUnsigned>(n)));
+        }
+
+        /*
+         * Return a randomly selected element from range(start, stop, step).
+         */
+        template <typename TStart, typename TStop, typename TStep = int,
+                  _detail::enable_if_integers<TStart, TStop, TStep> = 0>
+        std::common_type_t<TStart, TStop> randrange(TStart start_, TStop stop_, TStep step_ = 1)
+        {
+            using TInt = std::common_type_t<TStart, TStop>;
+            using TUnsigned = _detail::make_unsigned_t<TInt>;
+            TInt start = static_cast<TInt>(start_), stop = static_cast<TInt>(stop_);
+            TUnsigned width = static_cast<TUnsigned>(stop) - static_cast<TUnsigned>(start);
+            if (step_ == 1 && stop > start)
+            {
+                return static_cast<TInt>(static_cast<TUnsigned>(start) + _detail::bounded(gen, width));
+            }
+            if (step_ == 1)
+            {
+                throw std::range_error("empty range for randrange()");
+            }
+
+            TUnsigned n, step = static_cast<TUnsigned>(static_cast<TInt>(step_));
+            if (step_ > 0)
+            {
+                if (stop <= start)
+                {
+                    throw std::range_error("empty range for randrange()");
+                }
+                n = (width - 1) / step + 1;
+            }
+            else if (step_ < 0)
+            {
+                if (stop >= start)
+                {
+                    throw std::range_error("empty range for randrange()");
+                }
+                n = (TUnsigned(0) - width - 1) / (TUnsigned(0) - step) + 1;
+            }
+            else
+            {
+                throw std::range_error("zero step for randrange()");
+            }
+
+            return static_cast<TInt>(static_cast<TUnsigned>(start) + step * _detail::bounded(gen, n));
+        }
+
+        template <typename TInt, _detail::enable_if_integers<TInt> = 0>
+        TInt randrange(TInt stop)
+        {
+            return randrange(TInt(0), stop);
+        }
+
+        /*
+         * Return a random integer N such that a <= N <= b. Alias for randrange(a, b+1).
+         */
+        template <typename TA, typename TB, _detail::enable_if_integers<TA, TB> = 0>
+        std::common_type_t<TA, TB> randint(TA a_, TB b_)
+        {
+            using TInt = std::common_type_t<TA, TB>;
+            using TUnsigned = _detail::make_unsigned_t<TInt>;
+            TInt a = static_cast<TInt>(a_), b = static_cast<TInt>(b_);
+            if (b < a)
+            {
+                throw std::range_error("empty range for randrange()");
+            }
+            // b - a + 1 wraps to 0 for the full range of TInt, which bounded() treats as all bits.
+            TUnsigned width = static_cast<TUnsigned>(b) - static_cast<TUnsigned>(a) + 1;
+            return static_cast<TInt>(static_cast<TUnsigned>(a) + _detail::bounded(gen, width));
+        }
+
+        // Functions for sequences:
+        /*
+         * Return a random element from the non-empty sequence seq. If seq is empty, raises logic_error.
+         */
+        template <typename TContainer>
+        typename TContainer::value_type choice(TContainer const &container)
+        {
+            auto begin(container.begin());
+            auto size(std::distance(begin, container.end()));
+            if (!size)
+            {
+                throw std::logic_error("Cannot choose from an empty sequence");
+            }
+            auto rand_index(randrange(size));
+            std::advance(begin, rand_index);
+            return *begin;
+        }
+
+        /*
+         * Return the element at the index drawn by a weighted sampler kept in step with the population.
+         */
+        template <typename TContainer>
+        typename TContainer::value_type choice(TContainer const &container, DynamicWeightedSampler const &sampler)
+        {
+            if (sampler.size() != _detail::population_size(container))
+            {
+                throw std::invalid_argument("The number of weights does not match the population");
+            }
+            auto begin(container.begin());
+            std::advance(begin, sampler(gen));
+            return *begin;
+        }
+
+        /*
+         * Return a random element from the non-empty sequence seq. If seq is empty, raises logic_error.
+         */
+        template <typename T, std::size_t N>
+        T choice(T const (&array)[N])
+        {
+            if (!N)
+            {
+                throw std::logic_error("Cannot choose from an empty sequence");
+            }
+            auto rand_index(randrange(N));
+            return array[rand_index];
+        }
+
+        /*
+         * Shuffle the sequence x in place.
+         *   Note that for even rather small len(x), the total number of permutations of x is larger than the period of most random number generators;
+         *   this implies that most permutations of a long sequence can never be generated.
+         */
+        template <typename TContainer>
+        void shuffle(TContainer *container)
+        {
+            _detail::shuffle_range(container->begin(), container->end(), gen);
+        }
+
+        /*
+         * Shuffle the sequence x in place.
+         *   Note that for even rather small len(x), the total number of permutations of x is larger than the period of most random number generators;
+         *   this implies that most permutations of a long sequence can never be generated.
+         */
+        template <typename T, std::size_t N>
+        void shuffle(T (*array)[N])
+        {
+            _detail::shuffle_range(std::begin(*array), std::end(*array), gen);
+        }
+
+        /*
+         * Shuffle the sequence x in place with the same distribution as shuffle(), dealing elements into cache-sized
+         *   buckets first so that arrays far larger than the cache are not shuffled one cache miss per swap.
+         *   Uses a temporary copy of the sequence. The permutation differs from shuffle()'s for the same seed.
+         */
+        template <typename TContainer>
+        void shuffle(TContainer *container, cache_blocked_t)
+        {
+            _detail::blocked_shuffle(std::begin(*container), std::end(*container), gen);
+        }
+
+        template <typename T, std::size_t N>
+        void shuffle(T (*array)[N], cache_blocked_t)
+        {
+            _detail::blocked_shuffle(std::begin(*array), std::end(*array), gen);
+        }
+
+        /*
+         * Shuffle a random-access container in place on several threads (hardware_concurrency() if 0) with MergeShuffle.
+         *   Fixed-size blocks are Fisher-Yates shuffled independently, then neighbouring blocks are merged pairwise,
+         *   level by level, which keeps every permutation equally likely. Each block and each merge draws from its own
+         *   Philox4x32 stream, keyed by 64 bits taken from this generator, so the result depends on this generator's
+         *   state, not on the number of threads.
+         *   The final merge walks the whole range on one thread, at about one random bit per element.
+         */
+        template <typename TContainer>
+        void parallel_shuffle(TContainer *container, unsigned threads = 0)
+        {
+            constexpr std::uint64_t block = 1 << 16;
+            auto first = std::begin(*container);
+            std::uint64_t n = std::end(*container) - first;
+            std::uint64_t blocks = std::bit_ceil((n + block - 1) / block);
+            std::uint64_t task_key = _detail::random_bits64(gen);
+            auto bound = [&](std::uint64_t b) { return first + (b * (n / blocks) + std::min(b, n % blocks)); };
+            auto task_engine = [&](std::uint64_t stream)
+            {
+                philox4x32 rng(task_key);
+                rng.set_counter({0, 0, std::uint32_t(stream), std::uint32_t(stream >> 32)});
+                return rng;
+            };
+
+            // Streams are numbered like heap nodes: leaves are blocks..2*blocks-1 and a level of m merges uses m..2*m-1.
+            _detail::parallel_for(blocks, threads, [&](std::uint64_t b)
+            {
+                auto rng = task_engine(blocks + b);
+                _detail::shuffle_range(bound(b), bound(b + 1), rng);
+            });
+            for (std::uint64_t width = 2; width <= blocks; width *= 2)
+            {
+                std::uint64_t merges = blocks / width;
+                _detail::parallel_for(merges, threads, [&](std::uint64_t m)
+                {
+                    auto rng = task_engine(merges + m);
+                    _detail::merge_shuffled(bound(m * width), bound(m * width + width / 2), bound(m * width + width), rng);
+                });
+            }
+        }
+
+        /*
+         * Return a k length list of unique elements chosen from the population sequence or set. Used for random sampling without replacement.
+         *   Returns a new list containing elements from the population while leaving the original population unchanged.
+         *   The resulting list is in selection order so that all sub-slices will also be valid random samples.
+         *   This allows raffle winners (the sample) to be partitioned into grand prize and second place winners (the subslices).
+         */
+        template <typename TPopulation,
+                  typename std::enable_if<_detail::has_resize<TPopulation>::value, int>::type = 0>
+        TPopulation sample(TPopulation const &population, std::size_t k)
+        {
+            auto indices(_detail::sample_indices(gen, _detail::population_size(population), k));
+            std::vector<decltype(population.begin())> picked(k);
+            _detail::visit_indices(population, indices, [&](std::size_t slot, auto itr) { picked[slot] = itr; });
+            TPopulation result;
+            result.resize(k);
+            auto result_itr(result.begin());
+            for (auto itr : picked)
+            {
+                *result_itr = *itr;
+                std::advance(result_itr, 1);
+            }
+            return result;
+        }
+
+        template <typename TPopulation,
+                  typename std::enable_if<!_detail::has_resize<TPopulation>::value, int>::type = 0>
+        TPopulation sample(TPopulation const &population, std::size_t k)
+        {
+            TPopulation result;
+            auto indices(_detail::sample_indices(gen, _detail::population_size(population), k));
+            _detail::visit_indices(population, indices, [&](std::size_t, auto itr) { result.insert(*itr); });
+            return result;
+        }
+
+        template <typename T, std::size_t N, std::size_t K>
+        void sample(T const (&population)[N], T (*result)[K])
+        {
+            sample_dumb_array<T>(&population[0], &(*result)[0], N, K);
+        }
+
+        template <typename T, std::size_t N, std::size_t K>
+        void sample(std::array<T, N> const &population, std::array<T, K> *result)
+        {
+            sample_dumb_array<T>(population.data(), result->data(), N, K);
+        }
+
+        /*
+         * Return a k sized list of elements chosen from the population with replacement.
+         *   If the population is empty, raises logic_error.
+         */
+        template <typename TContainer>
+        std::vector<typename TContainer::value_type> choices(TContainer const &population, std::size_t k = 1)
+        {
+            std::uint64_t n = _detail::population_size(population);
+            if (!n)
+            {
+                throw std::logic_error("Cannot choose from an empty sequence");
+            }
+            std::vector<std::uint64_t> indices(k);
+            for (auto &index : indices)
+            {
+                index = _detail::bounded(gen, n);
+            }
+            return gather(population, indices);
+        }
+
+        /*
+         * Return a k sized list of elements chosen from the population with replacement, each picked with probability
+         *   proportional to its weight. The cumulative weights are computed once per call and searched by bisection;
+         *   for repeated draws from fixed weights, build an AliasTable instead.
+         */
+        template <typename TContainer, typename TWeights,
+                  typename std::enable_if<!std::is_arithmetic<TWeights>::value, int>::type = 0>
+        std::vector<typename TContainer::value_type> choices(TContainer const &population, TWeights const &weights, std::size_t k = 1)
+        {
+            std::vector<double> cum;
+            double total = 0.0;
+            for (auto weight : weights)
+            {
+                total += weight;
+                cum.push_back(total);
+            }
+            return choices(population, cum_weights, cum, k);
+        }
+
+        /*
+         * As above, with the running totals of the weights given directly.
+         */
+        template <typename TContainer, typename TWeights>
+        std::vector<typename TContainer::value_type> choices(TContainer const &population, cum_weights_t, TWeights const &cum, std::size_t k = 1)
+        {
+            std::uint64_t n = _detail::population_size(population);
+            if (static_cast<std::uint64_t>(std::distance(std::begin(cum), std::end(cum))) != n)
+            {
+                throw std::invalid_argument("The number of weights does not match the population");
+            }
+            if (!n)
+            {
+                throw std::logic_error("Cannot choose from an empty sequence");
+            }
+            double total = static_cast<double>(*std::prev(std::end(cum)));
+            if (!(total > 0.0))
+            {
+                throw std::invalid_argument("Total of weights must be greater than zero");
+            }
+            if (!std::isfinite(total))
+            {
+                throw std::invalid_argument("Total of weights must be finite");
+            }
+            std::vector<std::uint64_t> indices(k);
+            for (auto &index : indices)
+            {
+                auto itr = std::upper_bound(std::begin(cum), std::prev(std::end(cum)), _detail::uniform01(gen) * total);
+                index = std::distance(std::begin(cum), itr);
+            }
+            return gather(population, indices);
+        }
+
+        /*
+         * Return a k sized list of elements drawn with replacement using a prebuilt alias table over the population.
+         */
+        template <typename TContainer>
+        std::vector<typename TContainer::value_type> choices(TContainer const &population, AliasTable const &table, std::size_t k = 1)
+        {
+            if (table.size() != _detail::population_size(population))
+            {
+                throw std::invalid_argument("The number of weights does not match the population");
+            }
+            std::vector<std::uint64_t> indices(k);
+            for (auto &index : indices)
+            {
+                index = table(gen);
+            }
+            return gather(population, indices);
+        }
+
+        /*
+         * Return a k length list of unique elements chosen from the population with probabilities proportional to
+         *   weights, in the order successive weighted draws without replacement would pick them.
+         *   Elements with weight 0 are never chosen; raises range_error if fewer than k have a positive weight.
+         */
+        template <typename TContainer, typename TWeights>
+        std::vector<typename TContainer::value_type> weighted_sample(TContainer const &population, TWeights const &weights, std::size_t k)
+        {
+            check_weighted_sample(population, weights, k);
+            _detail::weighted_keys<std::uint64_t> keys(k);
+            if (k)
+            {
+                std::uint64_t i = 0;
+                for (auto weight : weights)
+                {
+                    keys.offer(gen, static_cast<double>(weight), i++);
+                }
+            }
+            return gather_weighted(population, keys, k);
+        }
+
+        /*
+         * weighted_sample() spread over threads (hardware_concurrency() if 0), for populations of millions.
+         *   The weights are cut into fixed chunks, each keyed by its own Philox4x32 stream of a 64-bit key drawn from
+         *   this generator, and the per-thread top-k heaps are merged at the end. The result depends on this
+         *   generator's state only, not on the number of threads, but differs from weighted_sample().
+         *   Weights must be random access.
+         */
+        template <typename TContainer, typename TWeights>
+        std::vector<typename TContainer::value_type> parallel_weighted_sample(TContainer const &population, TWeights const &weights, std::size_t k, unsigned threads = 0)
+        {
+            constexpr std::uint64_t chunk = 1 << 16;
+            std::uint64_t n = check_weighted_sample(population, weights, k);
+            std::uint64_t chunks = (n + chunk - 1) / chunk;
+            std::uint64_t chunk_key = _detail::random_bits64(gen);
+            threads = static_cast<unsigned>(std::min<std::uint64_t>(threads ? threads : std::max(1u, std::thread::hardware_concurrency()), std::max<std::uint64_t>(chunks, 1)));
+
+            // One task per thread, each striding over the chunks and folding them into its own heap.
+            std::vector<_detail::weighted_keys<std::uint64_t>> partial(threads, _detail::weighted_keys<std::uint64_t>(k));
+            _detail::parallel_for(threads, threads, [&](std::uint64_t t)
+            {
+                for (std::uint64_t c = t; k && c < chunks; c += threads)
+                {
+                    philox4x32 rng(chunk_key);
+                    rng.set_counter({0, 0, std::uint32_t(c), std::uint32_t(c >> 32)});
+                    _detail::weighted_keys<std::uint64_t> keys(k);
+                    auto weight = std::begin(weights) + c * chunk;
+                    for (std::uint64_t i = c * chunk, end = std::min(n, i + chunk); i < end; i++, ++weight)
+                    {
+                        keys.offer(rng, static_cast<double>(*weight), i);
+                    }
+                    partial[t].merge(keys);
+                }
+            });
+            for (unsigned t = 1; t < threads; t++)
+            {
+                partial[0].merge(partial[t]);
+            }
+            return gather_weighted(population, partial[0], k);
+        }
+
+        // The following functions generate specific real-valued distributions.
+        //   Function parameters are named after the corresponding variables in the distribution’s equation,
+        //   as used in common mathematical practice; most of these equations can be found in any statistics text.
+
+        /*
+         * Return the next random floating point number in the range [0.0, 1.0).
+         *   A float takes the top 24 bits of one 32-bit word and a double the top 53 bits of a 64-bit word,
+         *   scaled by a power of two, so every value is a multiple of 2^-24 (2^-53) and 1.0 is never returned.
+         *   A long double with a 64-bit significand takes a whole 64-bit word; elsewhere it is a double.
+         */
+        template <typename TReal = float>
+        TReal random()
+        {
+            return _detail::uniform_real<TReal>(gen);
+        }
+
+        /*
+         * random<double>(): 53 bits of resolution from one 64-bit engine word (two for 32-bit engines).
+         */
+        double random_double()
+        {
+            return random<double>();
+        }
+
+        /*
+         * Return a random floating point number N such that a <= N <= b for a <= b and b <= N <= a for b < a.
+         *   The end-point value b may or may not be included in the range depending on floating-point rounding in the equation a + (b-a) * random().
+         */
+        template <typename TReal = float>
+        TReal uniform(std::type_identity_t<TReal> a, std::type_identity_t<TReal> b)
+        {
+            return a + (b - a) * random<TReal>();
+        }
+
+        /*
+         * Return a random floating point number N such that low <= N <= high and with the specified mode between those bounds.
+         *   The low and high bounds default to zero and one.
+         *   The mode argument defaults to the midpoint between the bounds, giving a symmetric distribution.
+         */
+
+        template <typename TReal = float>
+        TReal triangular(std::type_identity_t<TReal> low = 0, std::type_identity_t<TReal> high = 1, std::type_identity_t<TReal> mode = TReal(0.5))
+        {
+            TReal u = random<TReal>();
+            TReal c = mode;
+            if (u > c)
+            {
+                u = 1 - u;
+                c = 1 - c;
+                std::swap(low, high);
+            }
+            return low + (high - low) * std::sqrt(u * c);
+        }
+
+        /*
+         * Beta distribution. Conditions on the parameters are alpha > 0 and beta > 0. Returned values range between 0 and 1.
+         */
+        template <typename TReal = float>
+        TReal betavariate(std::type_identity_t<TReal> alpha, std::type_identity_t<TReal> beta)
+        {
+            return BetaDist<TReal>(alpha, beta)(gen);
+        }
+
+        /*
+         * Dirichlet distribution. Every alpha must be > 0. Returns alphas.size() values in [0, 1] that sum to 1.
+         *   The batch form fills out with out.size() / alphas.size() draws back to back; for repeated draws with the
+         *   same alphas, a DirichletDist avoids the setup on every call.
+         */
+        template <typename TContainer>
+        std::vector<typename TContainer::value_type> dirichletvariate(TContainer const &alphas)
+        {
+            return DirichletDist<typename TContainer::value_type>(alphas)(gen);
+        }
+
+        template <typename TContainer>
+        void dirichletvariate(TContainer const &alphas, std::span<typename TContainer::value_type> out)
+        {
+            DirichletDist<typename TContainer::value_type>(alphas).fill(gen, out);
+        }
+
+        /*
+         * Exponential distribution. lambda is 1.0 divided by the desired mean. It should be nonzero.
+         *   Returned values range from 0 to positive infinity if lambda is positive,
+         *   and from negative infinity to 0 if lambda is negative.
+         */
+        template <typename TReal = float>
+        TReal expovariate(std::type_identity_t<TReal> lambda)
+        {
+            // 1 - u lies in (0, 1], so the log is finite.
+            return -std::log(1 - random<TReal>()) / lambda;
+        }
+
+        /*
+         * Exponential distribution drawn with the Ziggurat method, avoiding the log on most draws.
+         */
+        template <typename TReal = float>
+        TReal expovariate(std::type_identity_t<TReal> lambda, ziggurat_t)
+        {
+            return static_cast<TReal>(_detail::exponential_ziggurat(_detail::random_bits64(gen), gen)) / lambda;
+        }
+
+        /*
+         * Gamma distribution. (Not the gamma function!) Conditions on the parameters are alpha > 0 and beta > 0.
+         *   The probability distribution function is:
+         *
+         *              x ** (alpha - 1) * math.exp(-x / beta)
+         *    pdf(x) =  --------------------------------------
+         *                math.gamma(alpha) * beta ** alpha
+         */
+
+        template <typename TReal = float>
+        TReal gammavariate(std::type_identity_t<TReal> alpha, std::type_identity_t<TReal> beta)
+        {
+            return GammaDist<TReal>(alpha, beta)(gen);
+        }
+
+        /*
+         * Gaussian distribution. mu is the mean, and sigma is the standard deviation.
+         *   This is slightly faster than the normalvariate() function defined below.
+         */
+
+        template <typename TReal = float>
+        TReal gauss(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> sigma)
+        {
+            std::normal_distribution<TReal> dist(mu, sigma);
+            return dist(gen);
+        }
+
+        /*
+         * Gaussian distribution drawn with the Ziggurat method: one table lookup and compare for most draws,
+         *   with no log or trigonometric call, and the same output on every standard library.
+         */
+        template <typename TReal = float>
+        TReal gauss(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> sigma, ziggurat_t)
+        {
+            return mu + sigma * static_cast<TReal>(_detail::normal_ziggurat(_detail::random_bits64(gen), gen));
+        }
+
+        /*
+         * Normal distribution. mu is the mean, and sigma is the standard deviation.
+         */
+
+        template <typename TReal = float>
+        TReal normalvariate(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> sigma)
+        {
+            TReal z;
+            while (true)
+            {
+                TReal u1 = random<TReal>();
+                TReal u2 = 1 - random<TReal>();
+                z = _detail::nv_magicconst<TReal> * (u1 - TReal(0.5)) / u2;
+                TReal zz = z * z / 4;
+                if (zz <= -std::log(u2))
+                {
+                    break;
+                }
+            }
+            return mu + z * sigma;
+        }
+
+        template <typename TReal = float>
+        TReal normalvariate(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> sigma, ziggurat_t)
+        {
+            return gauss<TReal>(mu, sigma, ziggurat);
+        }
+
+        /*
+         * Circular data distribution. mu is the mean angle, expressed in radians between 0 and 2*pi,
+         *   and kappa is the concentration parameter, which must be greater than or equal to zero.
+         *   If kappa is equal to zero, this distribution reduces to a uniform random angle over the range 0 to 2*pi.
+         */
+
+        template <typename TReal = float>
+        TReal vonmisesvariate(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> kappa)
+        {
+            return VonMisesDist<TReal>(mu, kappa)(gen);
+        }
+
+        /*
+         * Pareto distribution. alpha is the shape parameter.
+         */
+
+        template <typename TReal = float>
+        TReal paretovariate(std::type_identity_t<TReal> alpha)
+        {
+            return ParetoDist<TReal>(alpha)(gen);
+        }
+
+        /*
+         * Weibull distribution. alpha is the scale parameter and beta is the shape parameter.
+         */
+
+        template <typename TReal = float>
+        TReal weibullvariate(std::type_identity_t<TReal> alpha, std::type_identity_t<TReal> beta)
+        {
+            return WeibullDist<TReal>(alpha, beta)(gen);
+        }
+
+        // Bulk versions:
+        //   Fill a whole span per call. Engine words are drawn a block at a time and converted in plain loops over
+        //   contiguous memory, so there is no per-value call or distribution object and the transforms can vectorize.
+        //   The values follow the same distributions as the scalar functions, but not the same sequence.
+
+        /*
+         * Fill out with random floating point numbers in the range [0.0, 1.0).
+         */
+        void random(std::span<float> out)
+        {
+            if constexpr (_detail::engine_bits<engine_type> == 0)
+            {
+                for (auto &x : out)
+                {
+                    x = random();
+                }
+            }
+            else
+            {
+                using word_type = std::conditional_t<_detail::engine_bits<engine_type> == 32, std::uint32_t, std::uint64_t>;
+                constexpr std::size_t chunk = 256;
+                word_type words[chunk];
+                for (std::size_t done = 0; done < out.size(); done += chunk)
+                {
+                    std::size_t n = std::min(chunk, out.size() - done);
+                    fill_words(words, n);
+                    float *dst = out.data() + done;
+                    for (std::size_t i = 0; i < n; i++)
+                    {
+                        dst[i] = _detail::to_float(words[i]);
+                    }
+                }
+            }
+        }
+
+        /*
+         * Fill out with random doubles in the range [0.0, 1.0), as random_double().
+         */
+        void random(std::span<double> out)
+        {
+            constexpr std::size_t chunk = 256;
+            std::uint64_t words[chunk];
+            for (std::size_t done = 0; done < out.size(); done += chunk)
+            {
+                std::size_t n = std::min(chunk, out.size() - done);
+                fill_words(words, n);
+                double *dst = out.data() + done;
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    dst[i] = _detail::to_double(words[i]);
+                }
+            }
+        }
+
+        /*
+         * Fill out with random floating point numbers between a and b, as uniform(a, b).
+         */
+        void uniform(std::span<float> out, float a, float b)
+        {
+            random(out);
+            float width = b - a;
+            for (auto &x : out)
+            {
+                x = a + width * x;
+            }
+        }
+
+        void uniform(std::span<double> out, double a, double b)
+        {
+            random(out);
+            double width = b - a;
+            for (auto &x : out)
+            {
+                x = a + width * x;
+            }
+        }
+
+        /*
+         * Fill out with exponential variates, as expovariate(lambda).
+         */
+        void expovariate(std::span<float> out, float lambda)
+        {
+            fill_expovariate(out, lambda);
+        }
+
+        void expovariate(std::span<double> out, double lambda)
+        {
+            fill_expovariate(out, lambda);
+        }
+
+        /*
+         * Fill out with Gaussian variates, as gauss(mu, sigma), using the Box-Muller transform on pairs of 64-bit words.
+         */
+        void gauss(std::span<float> out, float mu, float sigma)
+        {
+            fill_gauss(out, mu, sigma);
+        }
+
+        void gauss(std::span<double> out, double mu, double sigma)
+        {
+            fill_gauss(out, mu, sigma);
+        }
+
+        /*
+         * Fill out with Gaussian variates drawn with the Ziggurat method, a block of engine words at a time.
+         */
+        void gauss(std::span<float> out, float mu, float sigma, ziggurat_t)
+        {
+            fill_gauss(out, mu, sigma, ziggurat);
+        }
+
+        void gauss(std::span<double> out, double mu, double sigma, ziggurat_t)
+        {
+            fill_gauss(out, mu, sigma, ziggurat);
+        }
+
+        /*
+         * Fill out with exponential variates drawn with the Ziggurat method, a block of engine words at a time.
+         */
+        void expovariate(std::span<float> out, float lambda, ziggurat_t)
+        {
+            fill_expovariate(out, lambda, ziggurat);
+        }
+
+        void expovariate(std::span<double> out, double lambda, ziggurat_t)
+        {
+            fill_expovariate(out, lambda, ziggurat);
+        }
+
+        // Other functions
+        /*
+         * Return value has a <probability_> chance of being true
+         */
+        bool probability(float probability_)
+        {
+            float r = uniform(0.0f, 1.0f);
+            return r <= probability_;
+        }
+
+        /*
+         * Return a k length list of unique (or not) elements chosen from the range.
+         * If the range is empty, raises a range_error.
+         * If sampling without replacement, the algorithm to use is determined by the parameter `k`:
+         * - If k << n (k < n/10), the hash-based Fisher-Yates shuffle is used.
+         * - Otherweise, the array-based Fisher-Yates shuffle is used.
+         */
+        template <typename TA, typename TB, _detail::enable_if_integers<TA, TB> = 0>
+        std::vector<std::common_type_t<TA, TB>> sample(TA a_, TB b_, std::size_t k, bool unique = false)
+        {
+            using TInt = std::common_type_t<TA, TB>;
+            using TUnsigned = _detail::make_unsigned_t<TInt>;
+            TInt a = static_cast<TInt>(a_), b = static_cast<TInt>(b_);
+            if (b < a)
+            {
+                throw std::range_error("empty range for sample()");
+            }
+            // Size of [a, b]; 0 when it spans every value of TInt.
+            TUnsigned n = static_cast<TUnsigned>(b) - static_cast<TUnsigned>(a) + 1;
+            if (unique && n != 0 && n < k)
+            {
+                throw std::range_error("random vector unique but range is less than count");
+            }
+
+            std::vector<TInt> rand_is;
+            rand_is.reserve(k);
+            if (!unique)
+            {
+                for (std::size_t i = 0; i < k; i++)
+                {
+                    rand_is.push_back(static_cast<TInt>(static_cast<TUnsigned>(a) + _detail::bounded(gen, n)));
+                }
+            }
+            else
+            {
+                if (n == 0 || k < n / 10)
+                {
+                    // Partial Fisher-Yates over a virtual array of offsets, storing only the displaced slots.
+                    //   Bounds that fit in 64 bits are drawn in batches; the full range of a 64-bit or wider type is not.
+                    std::unordered_map<TUnsigned, TUnsigned> map{};
+                    bool batched = sizeof(TUnsigned) <= sizeof(std::uint64_t) && n != 0;
+                    _detail::descending_bounded targets(batched ? static_cast<std::uint64_t>(n) : 0);
+                    for (std::size_t i = 0; i < k; ++i)
+                    {
+                        TUnsigned slot = static_cast<TUnsigned>(i);
+                        TUnsigned j = slot + (batched ? static_cast<TUnsigned>(targets(gen)) : _detail::bounded(gen, TUnsigned(n - slot)));
+
+                        auto itr_j = map.find(j);
+                        TUnsigned valJ = itr_j == map.end() ? j : itr_j->second;
+                        auto itr_i = map.find(slot);
+                        TUnsigned valI = itr_i == map.end() ? slot : itr_i->second;
+
+                        rand_is.push_back(static_cast<TInt>(static_cast<TUnsigned>(a) + valJ));
+
+                        map[j] = valI;
+                    }
+                }
+                else
+                {
+                    std::vector<TInt> all;
+                    all.reserve(static_cast<std::size_t>(n));
+                    for (TUnsigned i = 0; i < n; ++i)
+                    {
+                        all.push_back(static_cast<TInt>(static_cast<TUnsigned>(a) + i));
+                    }
+                    shuffle(&all);
+                    std::copy(all.begin(), all.begin() + k, std::back_inserter(rand_is));
+                }
+            }
+            return rand_is;
+        }
+
+    private:
+        template <typename TContainer, typename TWeights>
+        static std::uint64_t check_weighted_sample(TContainer const &population, TWeights const &weights, std::size_t k)
+        {
+            std::uint64_t n = _detail::population_size(population);
+            if (static_cast<std::uint64_t>(std::distance(std::begin(weights), std::end(weights))) != n)
+            {
+                throw std::invalid_argument("The number of weights does not match the population");
+            }
+            if (k > n)
+            {
+                throw std::range_error("sample larger than population");
+            }
+            return n;
+        }
+
+        template <typename TContainer>
+        std::vector<typename TContainer::value_type> gather_weighted(TContainer const &population, _detail::weighted_keys<std::uint64_t> const &keys, std::size_t k)
+        {
+            if (keys.size() < k)
+            {
+                throw std::range_error("sample larger than the number of positive weights");
+            }
+            return gather(population, keys.ranked());
+        }
+
+        template <typename TContainer>
+        std::vector<typename TContainer::value_type> gather(TContainer const &population, std::vector<std::uint64_t> const &indices)
+        {
+            std::vector<typename TContainer::value_type> result;
+            result.reserve(indices.size());
+            std::vector<decltype(population.begin())> picked(indices.size());
+            _detail::visit_indices(population, indices, [&](std::size_t slot, auto itr) { picked[slot] = itr; });
+            for (auto itr : picked)
+            {
+                result.push_back(*itr);
+            }
+            return result;
+        }
+
+        // The bulk distributions at each precision.
+        template <typename TReal>
+        void fill_expovariate(std::span<TReal> out, TReal lambda)
+        {
+            random(out);
+            for (auto &x : out)
+            {
+                x = -std::log(1 - x) / lambda;
+            }
+        }
+
+        template <typename TReal>
+        void fill_expovariate(std::span<TReal> out, TReal lambda, ziggurat_t)
+        {
+            fill_ziggurat(out, [&](std::uint64_t bits) {
+                return static_cast<TReal>(_detail::exponential_ziggurat(bits, gen)) / lambda;
+            });
+        }
+
+        template <typename TReal>
+        void fill_gauss(std::span<TReal> out, TReal mu, TReal sigma)
+        {
+            constexpr std::size_t chunk = 256;
+            std::uint64_t words[chunk];
+            std::size_t pairs = out.size() / 2;
+            for (std::size_t done = 0; done < pairs; done += chunk / 2)
+            {
+                std::size_t n = std::min(chunk / 2, pairs - done);
+                fill_words(words, 2 * n);
+                TReal *dst = out.data() + 2 * done;
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    std::tie(dst[2 * i], dst[2 * i + 1]) = _detail::box_muller(words[2 * i], words[2 * i + 1], mu, sigma);
+                }
+            }
+            if (out.size() % 2)
+            {
+                out.back() = gauss<TReal>(mu, sigma);
+            }
+        }
+
+        template <typename TReal>
+        void fill_gauss(std::span<TReal> out, TReal mu, TReal sigma, ziggurat_t)
+        {
+            fill_ziggurat(out, [&](std::uint64_t bits) {
+                return mu + sigma * static_cast<TReal>(_detail::normal_ziggurat(bits, gen));
+            });
+        }
+
+        template <typename TReal, typename TDraw>
+        void fill_ziggurat(std::span<TReal> out, TDraw draw)
+        {
+            constexpr std::size_t chunk = 256;
+            std::uint64_t words[chunk];
+            for (std::size_t done = 0; done < out.size(); done += chunk)
+            {
+                std::size_t n = std::min(chunk, out.size() - done);
+                fill_words(words, n);
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    out[done + i] = draw(words[i]);
+                }
+            }
+        }
+
+        template <typename TWord>
+        void fill_words(TWord *out, std::size_t n)
+        {
+            if constexpr (_detail::has_fill<engine_type, TWord>::value)
+            {
+                gen.fill(out, n);
+            }
+            else if constexpr (sizeof(TWord) == 8)
+            {
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    out[i] = _detail::random_bits64(gen);
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    out[i] = _detail::random_bits32(gen);
+                }
+            }
+        }
+
+        void initialize()
+        {
+            if (stream_id == 0)
+            {
+                gen.seed(seed_value);
+                return;
+            }
+            std::seed_seq seq{seed_value,
+                              static_cast<unsigned>(stream_id),
+                              static_cast<unsigned>(stream_id >> 32)};
+            gen.seed(seq);
+        }
+
+        template <typename T>
+        void sample_dumb_array(T const *population, T *result, std::size_t n, std::size_t k)
+        {
+            for (auto j : _detail::sample_indices(gen, n, k))
+            {
+                *result++ = *(population + j);
+            }
+        }
+
+        unsigned seed_value;
+        std::uint64_t stream_id = 0;
+        engine_type gen;
+    };
+
+    using Random = BasicRandom<>;
+
+    namespace _detail
+    {
+        template <typename TEngine>
+        inline constexpr bool cheap_engine<BasicRandom<TEngine>> = cheap_engine<TEngine>;
+    } // namespace _detail
+
+    // Distributions:
+    //   Parameter sets for the draws above, each with operator()(rng) for one value and fill(rng, out) for a span,
+    //   so that generic code such as parallel_fill() can be handed "what to draw" as a value. The real-valued ones
+    //   take their precision from the parameters (GaussDist{0.0, 1.0} draws doubles); fill() needs float or double.
+
+    /*
+     * uniform(a, b); the defaults give random().
+     */
+    template <typename TReal = float>
+    struct UniformDist
+    {
+        using result_type = TReal;
+
+        TReal a = 0;
+        TReal b = 1;
+
+        template <typename TEngine>
+        TReal operator()(BasicRandom<TEngine> &rng) const { return rng.template uniform<TReal>(a, b); }
+
+        template <typename TEngine>
+        void fill(BasicRandom<TEngine> &rng, std::span<TReal> out) const { rng.uniform(out, a, b); }
+    };
+
+    /*
+     * gauss(mu, sigma).
+     */
+    template <typename TReal = float>
+    struct GaussDist
+    {
+        using result_type = TReal;
+
+        TReal mu = 0;
+        TReal sigma = 1;
+
+        template <typename TEngine>
+        TReal operator()(BasicRandom<TEngine> &rng) const { return rng.template gauss<TReal>(mu, sigma); }
+
+        template <typename TEngine>
+        void fill(BasicRandom<TEngine> &rng, std::span<TReal> out) const { rng.gauss(out, mu, sigma); }
+    };
+
+    /*
+     * expovariate(lambda).
+     */
+    template <typename TReal = float>
+    struct ExpoDist
+    {
+        using result_type = TReal;
+
+        TReal lambda = 1;
+
+        template <typename TEngine>
+        TReal operator()(BasicRandom<TEngine> &rng) const { return rng.template expovariate<TReal>(lambda); }
+
+        template <typename TEngine>
+        void fill(BasicRandom<TEngine> &rng, std::span<TReal> out) const { rng.expovariate(out, lambda); }
+    };
+
+    /*
+     * randint(a, b) for any integer type accepted by randint().
+     */
+    template <typename TInt>
+    struct RandintDist
+    {
+        using result_type = TInt;
+
+        TInt a;
+        TInt b;
+
+        template <typename TEngine>
+        TInt operator()(BasicRandom<TEngine> &rng) const { return rng.randint(a, b); }
+
+        template <typename TEngine>
+        void fill(BasicRandom<TEngine> &rng, std::span<TInt> out) const
+        {
+            for (auto &x : out)
+            {
+                x = rng.randint(a, b);
+            }
+        }
+    };
+
+    // Shape-parameter distributions:
+    //   These precompute everything that depends only on the parameters, so a draw costs no setup. They work with
+    //   any uniform random bit generator, a BasicRandom included, and draw the same values as the BasicRandom
+    //   functions of the same name given the same engine state.
+
+    /*
+     * Gamma distribution, as gammavariate(alpha, beta).
+     *   Uses G. Marsaglia and W.W. Tsang, "A simple method for generating gamma variables",
+     *   ACM TOMS 26 (2000), 363-372: a cubed, shifted normal variate accepted by a squeeze test, so most draws cost
+     *   one normal and one uniform and no log. For alpha < 1 it draws Gamma(alpha + 1) and scales by u ** (1 / alpha).
+     */
+    template <typename TReal>
+    class GammaDist
+    {
+    public:
+        using result_type = TReal;
+
+        GammaDist(TReal alpha_, TReal beta_) : alpha(alpha_), beta(beta_)
+        {
+            if (!(alpha > 0) || !(beta > 0))
+            {
+                throw std::invalid_argument("gammavariate: alpha and beta must be > 0.0");
+            }
+            d = (alpha < 1 ? alpha + 1 : alpha) - TReal(1) / 3;
+            c = 1 / std::sqrt(9 * d);
+            ainv = 1 / alpha;
+        }
+
+        template <typename TEngine>
+        TReal operator()(TEngine &gen) const
+        {
+            TReal x = marsaglia_tsang(gen);
+            if (alpha < 1)
+            {
+                x *= std::pow(1 - _detail::uniform_real<TReal>(gen), ainv);
+            }
+            return x * beta;
+        }
+
+        /*
+         * Natural log of a Gamma(alpha, 1) variate, drawn from the same values as operator() would use.
+         *   Stays finite when alpha is so small that the variate itself underflows to 0.
+         */
+        template <typename TEngine>
+        TReal log_variate(TEngine &gen) const
+        {
+            TReal x = std::log(marsaglia_tsang(gen));
+            if (alpha < 1)
+            {
+                x += std::log(1 - _detail::uniform_real<TReal>(gen)) * ainv;
+            }
+            return x;
+        }
+
+        template <typename TEngine>
+        void fill(TEngine &gen, std::span<TReal> out) const
+        {
+            for (auto &x : out)
+            {
+                x = (*this)(gen);
+            }
+        }
+
+    private:
+        // Gamma(alpha, 1), or Gamma(alpha + 1, 1) when alpha < 1.
+        template <typename TEngine>
+        TReal marsaglia_tsang(TEngine &gen) const
+        {
+            while (true)
+            {
+                TReal x = static_cast<TReal>(_detail::normal_ziggurat(_detail::random_bits64(gen), gen));
+                TReal v = 1 + c * x;
+                if (v <= 0)
+                {
+                    continue;
+                }
+                v = v * v * v;
+                TReal u = _detail::uniform_real<TReal>(gen);
+                TReal x2 = x * x;
+                if (u < 1 - TReal(0.0331) * x2 * x2 || std::log(u) < x2 / 2 + d * (1 - v + std::log(v)))
+                {
+                    return d * v;
+                }
+            }
+        }
+
+        TReal alpha;
+        TReal beta;
+        TReal d;
+        TReal c;
+        TReal ainv;
+    };
+
+    /*
+     * Beta distribution, as betavariate(alpha, beta): X / (X + Y) for X ~ Gamma(alpha) and Y ~ Gamma(beta).
+     *   When either shape is below 1 the ratio is taken from the logs, so tiny shapes still give values in [0, 1].
+     */
+    template <typename TReal>
+    class BetaDist
+    {
+    public:
+        using result_type = TReal;
+
+        BetaDist(TReal alpha, TReal beta) : x(alpha, 1), y(beta, 1), small(alpha < 1 || beta < 1) {}
+
+        template <typename TEngine>
+        TReal operator()(TEngine &gen) const
+        {
+            if (small)
+            {
+                TReal log_x = x.log_variate(gen);
+                return 1 / (1 + std::exp(y.log_variate(gen) - log_x));
+            }
+            TReal value = x(gen);
+            return value / (value + y(gen));
+        }
+
+        template <typename TEngine>
+        void fill(TEngine &gen, std::span<TReal> out) const
+        {
+            for (auto &value : out)
+            {
+                value = (*this)(gen);
+            }
+        }
+
+    private:
+        GammaDist<TReal> x;
+        GammaDist<TReal> y;
+        bool small;
+    };
+
+    /*
+     * Dirichlet distribution, as dirichletvariate(alphas): k gamma variates Gamma(alphas[i]) normalised to sum to 1.
+     *   A draw is a vector of k = alphas.size() values; fill() writes out.size() / k draws back to back.
+     */
+    template <typename TReal>
+    class DirichletDist
+    {
+    public:
+        using result_type = std::vector<TReal>;
+
+        template <typename TContainer>
+        explicit DirichletDist(TContainer const &alphas)
+        {
+            for (auto alpha : alphas)
+            {
+                if (!(alpha > 0))
+                {
+                    throw std::invalid_argument("dirichletvariate: every alpha must be > 0.0");
+                }
+                gammas.emplace_back(static_cast<TReal>(alpha), TReal(1));
+                small = small || alpha < 1;
+            }
+            if (gammas.empty())
+            {
+                throw std::invalid_argument("dirichletvariate: alphas must not be empty");
+            }
+        }
+
+        std::size_t size() const
+        {
+            return gammas.size();
+        }
+
+        template <typename TEngine>
+        std::vector<TReal> operator()(TEngine &gen) const
+        {
+            std::vector<TReal> result(gammas.size());
+            draw(gen, result.data());
+            return result;
+        }
+
+        template <typename TEngine>
+        void fill(TEngine &gen, std::span<TReal> out) const
+        {
+            if (out.size() % gammas.size() != 0)
+            {
+                throw std::invalid_argument("dirichletvariate: output size must be a multiple of the number of alphas");
+            }
+            for (std::size_t i = 0; i < out.size(); i += gammas.size())
+            {
+                draw(gen, out.data() + i);
+            }
+        }
+
+    private:
+        template <typename TEngine>
+        void draw(TEngine &gen, TReal *row) const
+        {
+            std::size_t k = gammas.size();
+            if (small)
+            {
+                // Normalise in log space, relative to the largest component, so underflowing variates still count.
+                TReal largest = -std::numeric_limits<TReal>::infinity();
+                for (std::size_t i = 0; i < k; i++)
+                {
+                    row[i] = gammas[i].log_variate(gen);
+                    largest = std::max(largest, row[i]);
+                }
+                for (std::size_t i = 0; i < k; i++)
+                {
+                    row[i] = std::exp(row[i] - largest);
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < k; i++)
+                {
+                    row[i] = gammas[i](gen);
+                }
+            }
+            TReal sum = 0;
+            for (std::size_t i = 0; i < k; i++)
+            {
+                sum += row[i];
+            }
+            for (std::size_t i = 0; i < k; i++)
+            {
+                row[i] /= sum;
+            }
+        }
+
+        std::vector<GammaDist<TReal>> gammas;
+        bool small = false;
+    };
+
+    /*
+     * Von Mises distribution, as vonmisesvariate(mu, kappa) (Best & Fisher's rejection method).
+     */
+    template <typename TReal>
+    class VonMisesDist
+    {
+    public:
+        using result_type = TReal;
+
+        VonMisesDist(TReal mu, TReal kappa_) : kappa(kappa_), mean(std::fmod(mu, 2 * pi))
+        {
+            if (kappa > TReal(1e-6))
+            {
+                TReal a = 1 + std::sqrt(1 + 4 * kappa * kappa);
+                TReal b = (a - std::sqrt(2 * a)) / (2 * kappa);
+                r = (1 + b * b) / (2 * b);
+            }
+        }
+
+        template <typename TEngine>
+        TReal operator()(TEngine &gen) const
+        {
+            if (kappa <= TReal(1e-6))
+            {
+                return 2 * pi * _detail::uniform_real<TReal>(gen);
+            }
+
+            TReal f;
+            while (true)
+            {
+                TReal z = std::cos(pi * _detail::uniform_real<TReal>(gen));
+                f = (1 + r * z) / (r + z);
+                TReal c = kappa * (r - f);
+                TReal u2 = _detail::uniform_real<TReal>(gen);
+                if (u2 < c * (2 - c) || u2 <= c * std::exp(1 - c))
+                {
+                    break;
+                }
+            }
+            return _detail::uniform_real<TReal>(gen) > TReal(0.5) ? mean + std::acos(f) : mean - std::acos(f);
+        }
+
+        template <typename TEngine>
+        void fill(TEngine &gen, std::span<TReal> out) const
+        {
+            for (auto &x : out)
+            {
+                x = (*this)(gen);
+            }
+        }
+
+    private:
+        static constexpr TReal pi = std::numbers::pi_v<TReal>;
+
+        TReal kappa;
+        TReal mean;
+        TReal r = 0;
+    };
+
+    /*
+     * Pareto distribution, as paretovariate(alpha).
+     */
+    template <typename TReal>
+    class ParetoDist
+    {
+    public:
+        using result_type = TReal;
+
+        explicit ParetoDist(TReal alpha) : inverse_alpha(1 / alpha) {}
+
+        template <typename TEngine>
+        TReal operator()(TEngine &gen) const
+        {
+            return transform(_detail::uniform_real<TReal>(gen));
+        }
+
+        // Uniforms first, then the transform in a separate loop that the compiler can vectorize.
+        template <typename TEngine>
+        void fill(TEngine &gen, std::span<TReal> out) const
+        {
+            for (auto &x : out)
+            {
+                x = _detail::uniform_real<TReal>(gen);
+            }
+            for (auto &x : out)
+            {
+                x = transform(x);
+            }
+        }
+
+    private:
+        TReal transform(TReal u) const
+        {
+            return 1 / std::pow(1 - u, inverse_alpha);
+        }
+
+        TReal inverse_alpha;
+    };
+
+    /*
+     * Weibull distribution, as weibullvariate(alpha, beta).
+     */
+    template <typename TReal>
+    class WeibullDist
+    {
+    public:
+        using result_type = TReal;
+
+        WeibullDist(TReal alpha_, TReal beta) : alpha(alpha_), inverse_beta(1 / beta) {}
+
+        template <typename TEngine>
+        TReal operator()(TEngine &gen) const
+        {
+            return transform(_detail::uniform_real<TReal>(gen));
+        }
+
+        // Uniforms first, then the transform in a separate loop that the compiler can vectorize.
+        template <typename TEngine>
+        void fill(TEngine &gen, std::span<TReal> out) const
+        {
+            for (auto &x : out)
+            {
+                x = _detail::uniform_real<TReal>(gen);
+            }
+            for (auto &x : out)
+            {
+                x = transform(x);
+            }
+        }
+
+    private:
+        TReal transform(TReal u) const
+        {
+            return alpha * std::pow(-std::log(1 - u), inverse_beta);
+        }
 
-    inline float const SG_MAGICCONST = 1.0f + std::log(4.5f);
-    inline float const NV_MAGICCONST = static_cast<float>(4.0f * std::exp(-0.5) / std::sqrt(2.0f));
+        TReal alpha;
+        TReal inverse_beta;
+    };
 
-    static void initialize()
+    /*
+     * Fill out with draws from distribution on several threads (hardware_concurrency() if 0).
+     *   The output is cut into fixed chunks of 2^16 values, and chunk c is filled from philox4x32(seed) started at
+     *   counter c << 64, so the bytes written depend only on seed and out.size(), never on the number of threads.
+     */
+    template <typename TDistribution>
+    inline void parallel_fill(std::span<typename TDistribution::result_type> out, TDistribution const &distribution,
+                              std::uint64_t seed, unsigned threads = 0)
     {
-        gen.seed(seed_value);
+        constexpr std::size_t chunk = 1 << 16;
+        std::uint64_t chunks = (out.size() + chunk - 1) / chunk;
+        _detail::parallel_for(chunks, threads, [&](std::uint64_t c)
+        {
+            BasicRandom<philox4x32> rng;
+            rng.engine().seed(seed);
+            rng.engine().set_counter({0, 0, std::uint32_t(c), std::uint32_t(c >> 32)});
+            std::size_t first = static_cast<std::size_t>(c * chunk);
+            distribution.fill(rng, out.subspan(first, std::min(chunk, out.size() - first)));
+        });
+    }
+
+    /*
+     * Uniform sample of k items from a stream of unknown length, using Li's Algorithm L
+     *   ("Reservoir-Sampling Algorithms of Time Complexity O(n(1 + log(N/n)))", 1994).
+     *   Instead of a draw per item, it draws the number of items to skip, so the engine runs O(k log(n/k)) times.
+     *   Reservoirs fed from different threads (with different seeds or streams) can be merged into one sample.
+     */
+    template <typename T, typename TEngine = std::mt19937>
+    class Reservoir
+    {
+    public:
+        explicit Reservoir(std::size_t k_, unsigned seed = 0, std::uint64_t stream = 0)
+            : Reservoir(k_, BasicRandom<TEngine>(seed, stream))
+        {
+        }
+
+        Reservoir(std::size_t k_, BasicRandom<TEngine> rng_) : k(k_), rng(std::move(rng_))
+        {
+            if (!k)
+            {
+                throw std::invalid_argument("Reservoir: k must be > 0");
+            }
+            items.reserve(k);
+        }
+
+        /*
+         * Offer one item from the stream.
+         */
+        void push(T const &item)
+        {
+            if (items.size() < k)
+            {
+                fill(item);
+            }
+            else if (count == next)
+            {
+                replace(item);
+            }
+            else
+            {
+                count++;
+            }
+        }
+
+        /*
+         * Offer a batch of items; skipped items are not touched at all.
+         */
+        void push(std::span<T const> batch)
+        {
+            std::size_t i = 0;
+            while (i < batch.size() && items.size() < k)
+            {
+                fill(batch[i++]);
+            }
+            while (i < batch.size())
+            {
+                std::uint64_t skip = next - count;
+                if (skip >= batch.size() - i)
+                {
+                    count += batch.size() - i;
+                    return;
+                }
+                i += static_cast<std::size_t>(skip);
+                count += skip;
+                replace(batch[i++]);
+            }
+        }
+
+        /*
+         * Fold another reservoir into this one, as if this one had also seen the other's stream.
+         *   Each kept item holds one of the k smallest of n uniform keys; the largest is the threshold w and the
+         *   others are uniform below it. Redrawing those keys and keeping the k smallest of both sides gives
+         *   exactly the sample of the combined stream, and the new threshold lets push() carry on afterwards.
+         */
+        void merge(Reservoir const &other)
+        {
+            if (other.k != k || &other == this)
+            {
+                throw std::invalid_argument("Reservoir: can only merge a distinct reservoir of the same size");
+            }
+            std::vector<std::pair<double, T const *>> keyed;
+            keyed.reserve(items.size() + other.items.size());
+            std::vector<T> mine(std::move(items));
+            draw_keys(mine, w, &keyed);
+            draw_keys(other.items, other.w, &keyed);
+            items.clear();
+            count += other.count;
+            if (keyed.empty())
+            {
+                return;
+            }
+
+            std::size_t keep = std::min(k, keyed.size());
+            std::nth_element(keyed.begin(), keyed.begin() + (keep - 1), keyed.end(),
+                             [](auto const &lhs, auto const &rhs) { return lhs.first < rhs.first; });
+            for (std::size_t i = 0; i < keep; i++)
+            {
+                items.push_back(*keyed[i].second);
+            }
+            if (items.size() == k)
+            {
+                w = keyed[keep - 1].first;
+                next = count + skip_length();
+            }
+        }
+
+        /*
+         * The current sample, in no particular order; all items if fewer than k have been seen.
+         */
+        std::vector<T> const &sample() const { return items; }
+
+        std::size_t capacity() const { return k; }
+
+        // Number of items offered so far.
+        std::uint64_t seen() const { return count; }
+
+    private:
+        void fill(T const &item)
+        {
+            items.push_back(item);
+            count++;
+            if (items.size() == k)
+            {
+                w = std::exp(std::log(_detail::open01(rng)) / k);
+                next = count + skip_length();
+            }
+        }
+
+        void replace(T const &item)
+        {
+            items[static_cast<std::size_t>(_detail::bounded(rng, std::uint64_t(k)))] = item;
+            count++;
+            w *= std::exp(std::log(_detail::open01(rng)) / k);
+            next = count + skip_length();
+        }
+
+        // Items to pass over before the next one enters the reservoir: geometric with success probability w.
+        std::uint64_t skip_length()
+        {
+            double skip = std::floor(std::log(_detail::open01(rng)) / std::log1p(-w));
+            std::uint64_t room = ~std::uint64_t(0) - count;
+            return skip < static_cast<double>(room) ? static_cast<std::uint64_t>(skip) : room;
+        }
+
+        // Keys consistent with what a reservoir knows: U(0, 1) before it fills, else w on one item and U(0, w) on the rest.
+        void draw_keys(std::vector<T> const &source, double threshold, std::vector<std::pair<double, T const *>> *keyed)
+        {
+            bool full = source.size() == k;
+            std::size_t holder = full ? static_cast<std::size_t>(_detail::bounded(rng, std::uint64_t(k))) : 0;
+            for (std::size_t i = 0; i < source.size(); i++)
+            {
+                double key = !full ? _detail::uniform01(rng) : i == holder ? threshold : threshold * _detail::uniform01(rng);
+                keyed->emplace_back(key, &source[i]);
+            }
+        }
+
+        std::size_t k;
+        BasicRandom<TEngine> rng;
+        std::vector<T> items;
+        std::uint64_t count = 0;
+        std::uint64_t next = 0;
+        double w = 1.0;
+    };
+
+    /*
+     * Weighted reservoir over a stream of unknown length: keeps k distinct items, each chosen with probability
+     *   proportional to its weight (Efraimidis & Spirakis' A-ExpJ). Reservoirs filled from different shards of a
+     *   stream can be merged into the sample of the whole stream.
+     */
+    template <typename T, typename TEngine = std::mt19937>
+    class WeightedReservoir
+    {
+    public:
+        explicit WeightedReservoir(std::size_t k_, unsigned seed = 0, std::uint64_t stream = 0)
+            : WeightedReservoir(k_, BasicRandom<TEngine>(seed, stream))
+        {
+        }
+
+        WeightedReservoir(std::size_t k_, BasicRandom<TEngine> rng_) : keys(k_), k(k_), rng(std::move(rng_))
+        {
+            if (!k)
+            {
+                throw std::invalid_argument("WeightedReservoir: k must be > 0");
+            }
+        }
+
+        /*
+         * Offer one item with a non-negative weight; items of weight 0 are never kept.
+         */
+        void push(T const &item, double weight)
+        {
+            keys.offer(rng, weight, item);
+            count++;
+        }
+
+        void merge(WeightedReservoir const &other)
+        {
+            if (other.k != k || &other == this)
+            {
+                throw std::invalid_argument("WeightedReservoir: can only merge a distinct reservoir of the same size");
+            }
+            keys.merge(other.keys);
+            count += other.count;
+        }
+
+        /*
+         * The current sample in draw order; fewer than k items if fewer have had a positive weight.
+         */
+        std::vector<T> sample() const { return keys.ranked(); }
+
+        std::size_t capacity() const { return k; }
+
+        // Number of items offered so far.
+        std::uint64_t seen() const { return count; }
+
+    private:
+        _detail::weighted_keys<T> keys;
+        std::size_t k;
+        BasicRandom<TEngine> rng;
+        std::uint64_t count = 0;
+    };
+
+    /*
+     * Counter-based random access (Salmon, Moraes, Dror & Shaw, "Parallel random numbers: as easy as 1, 2, 3", SC'11).
+     *   Every value is a pure function of a key and its index in the stream, so any thread or process can compute
+     *   any part of a stream without generating what comes before it, and shards always agree bit for bit.
+     *   Word i for a key is word i of philox4x32(key), so uniform(key, i) is element i of
+     *   BasicRandom<philox4x32>(key).random(out), and gauss(key, i, mu, sigma) is element i of its gauss(out, mu, sigma)
+     *   for spans of even length. Passing `threefry` uses Threefry2x64-20 blocks instead.
+     */
+    namespace counter
+    {
+
+        /*
+         * Tag selecting Threefry2x64-20 instead of Philox4x32-10.
+         */
+        struct threefry_t
+        {
+            explicit threefry_t() = default;
+        };
+
+        inline constexpr threefry_t threefry{};
+
+        namespace _detail
+        {
+
+            inline std::array<std::uint32_t, 4> philox_block(std::uint64_t key, std::uint64_t index)
+            {
+                return randomcpp::_detail::philox4x32_10({std::uint32_t(index), std::uint32_t(index >> 32), 0, 0},
+                                                         {std::uint32_t(key), std::uint32_t(key >> 32)});
+            }
+
+            inline std::array<std::uint32_t, 4> threefry_block(std::uint64_t key, std::uint64_t index)
+            {
+                auto block = randomcpp::_detail::threefry2x64_20({index, 0}, {key, 0});
+                return {std::uint32_t(block[0]), std::uint32_t(block[0] >> 32), std::uint32_t(block[1]), std::uint32_t(block[1] >> 32)};
+            }
+
+            // Words offset, offset + 1, ... of the stream, four per block.
+            template <typename TBlock>
+            inline void fill_bits(std::uint64_t key, std::uint64_t offset, std::uint32_t *out, std::size_t n, TBlock block)
+            {
+                std::uint64_t index = offset / 4;
+                unsigned first = static_cast<unsigned>(offset % 4);
+                for (std::size_t done = 0; done < n; index++, first = 0)
+                {
+                    auto words = block(key, index);
+                    for (unsigned j = first; j < 4 && done < n; j++)
+                    {
+                        out[done++] = words[j];
+                    }
+                }
+            }
+
+            template <typename TBlock>
+            inline void fill_uniform(std::uint64_t key, std::uint64_t offset, std::span<float> out, TBlock block)
+            {
+                constexpr std::size_t chunk = 256;
+                std::uint32_t words[chunk];
+                for (std::size_t done = 0; done < out.size(); done += chunk)
+                {
+                    std::size_t n = std::min(chunk, out.size() - done);
+                    fill_bits(key, offset + done, words, n, block);
+                    for (std::size_t i = 0; i < n; i++)
+                    {
+                        out[done + i] = randomcpp::_detail::to_float(words[i]);
+                    }
+                }
+            }
+
+            // Values 2j and 2j + 1: Box-Muller on the two 64-bit words made of stream words 4j..4j+3, low word first,
+            // as BasicRandom<philox4x32>::gauss(out, mu, sigma) combines them.
+            inline std::pair<float, float> box_muller(std::uint32_t const *words, float mu, float sigma)
+            {
+                return randomcpp::_detail::box_muller((std::uint64_t(words[1]) << 32) | words[0],
+                                                      (std::uint64_t(words[3]) << 32) | words[2], mu, sigma);
+            }
+
+            template <typename TBlock>
+            inline float gauss(std::uint64_t key, std::uint64_t counter, float mu, float sigma, TBlock block)
+            {
+                std::uint32_t words[4];
+                fill_bits(key, 4 * (counter / 2), words, 4, block);
+                auto pair = box_muller(words, mu, sigma);
+                return counter % 2 ? pair.second : pair.first;
+            }
+
+            template <typename TBlock>
+            inline void fill_gauss(std::uint64_t key, std::uint64_t offset, std::span<float> out, float mu, float sigma, TBlock block)
+            {
+                constexpr std::size_t chunk = 256;
+                std::uint32_t words[chunk];
+                std::uint64_t end = offset + out.size();
+                for (std::uint64_t pair = offset / 2; 2 * pair < end; pair += chunk / 4)
+                {
+                    std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(chunk / 4, (end + 1) / 2 - pair));
+                    fill_bits(key, 4 * pair, words, 4 * n, block);
+                    for (std::size_t i = 0; i < n; i++)
+                    {
+                        auto values = box_muller(words + 4 * i, mu, sigma);
+                        std::uint64_t index = 2 * (pair + i);
+                        if (index >= offset)
+                        {
+                            out[index - offset] = values.first;
+                        }
+                        if (index + 1 < end)
+                        {
+                            out[index + 1 - offset] = values.second;
+                        }
+                    }
+                }
+            }
+
+        } // namespace _detail
+
+        /*
+         * Word `counter` of the stream for `key`: 32 uniformly distributed bits.
+         */
+        inline std::uint32_t bits(std::uint64_t key, std::uint64_t counter)
+        {
+            return _detail::philox_block(key, counter / 4)[counter % 4];
+        }
+
+        inline std::uint32_t bits(std::uint64_t key, std::uint64_t counter, threefry_t)
+        {
+            return _detail::threefry_block(key, counter / 4)[counter % 4];
+        }
+
+        /*
+         * Value `counter` of the stream as a floating point number in the range [0.0, 1.0), like random().
+         */
+        inline float uniform(std::uint64_t key, std::uint64_t counter)
+        {
+            return randomcpp::_detail::to_float(bits(key, counter));
+        }
+
+        inline float uniform(std::uint64_t key, std::uint64_t counter, threefry_t)
+        {
+            return randomcpp::_detail::to_float(bits(key, counter, threefry));
+        }
+
+        /*
+         * Value `counter` of the stream as a Gaussian variate, like gauss(mu, sigma).
+         *   Values 2j and 2j + 1 are the two halves of one Box-Muller transform.
+         */
+        inline float gauss(std::uint64_t key, std::uint64_t counter, float mu = 0.0f, float sigma = 1.0f)
+        {
+            return _detail::gauss(key, counter, mu, sigma, _detail::philox_block);
+        }
+
+        inline float gauss(std::uint64_t key, std::uint64_t counter, float mu, float sigma, threefry_t)
+        {
+            return _detail::gauss(key, counter, mu, sigma, _detail::threefry_block);
+        }
+
+        // Block versions:
+        //   Fill out with values offset, offset + 1, ... of the stream, the same as the scalar functions give.
+
+        inline void bits(std::uint64_t key, std::uint64_t offset, std::span<std::uint32_t> out)
+        {
+            _detail::fill_bits(key, offset, out.data(), out.size(), _detail::philox_block);
+        }
+
+        inline void bits(std::uint64_t key, std::uint64_t offset, std::span<std::uint32_t> out, threefry_t)
+        {
+            _detail::fill_bits(key, offset, out.data(), out.size(), _detail::threefry_block);
+        }
+
+        inline void uniform(std::uint64_t key, std::uint64_t offset, std::span<float> out)
+        {
+            _detail::fill_uniform(key, offset, out, _detail::philox_block);
+        }
+
+        inline void uniform(std::uint64_t key, std::uint64_t offset, std::span<float> out, threefry_t)
+        {
+            _detail::fill_uniform(key, offset, out, _detail::threefry_block);
+        }
+
+        inline void gauss(std::uint64_t key, std::uint64_t offset, std::span<float> out, float mu = 0.0f, float sigma = 1.0f)
+        {
+            _detail::fill_gauss(key, offset, out, mu, sigma, _detail::philox_block);
+        }
+
+        inline void gauss(std::uint64_t key, std::uint64_t offset, std::span<float> out, float mu, float sigma, threefry_t)
+        {
+            _detail::fill_gauss(key, offset, out, mu, sigma, _detail::threefry_block);
+        }
+
+    } // namespace counter
+
+    namespace _detail
+    {
+
+        // Seed shared by the per-thread generators; bumping the epoch makes every thread reseed on its next call.
+        inline std::atomic<unsigned> seed_value{0};
+        inline std::atomic<std::uint64_t> seed_epoch{0};
+        inline std::atomic<std::uint64_t> next_stream{0};
+
+        struct thread_slot
+        {
+            Random rng;
+            std::uint64_t stream;
+            std::uint64_t epoch;
+        };
+
+        inline thread_slot &this_thread_slot()
+        {
+            thread_local thread_slot slot{Random(), next_stream.fetch_add(1, std::memory_order_relaxed), ~std::uint64_t(0)};
+            return slot;
+        }
+
+        inline Random &global_instance()
+        {
+            static Random inst;
+            return inst;
+        }
+
+        inline void reseed_threads(unsigned a)
+        {
+            seed_value.store(a, std::memory_order_relaxed);
+            seed_epoch.fetch_add(1, std::memory_order_release);
+        }
+
+    } // namespace _detail
+
+    /*
+     * Return the calling thread's own generator, lazily seeded from the last seed() value and the thread's stream id.
+     *   Stream ids are handed out in order of first use, so the first thread to draw gets the plain seed() sequence.
+     *   No locks are taken; each thread only ever touches its own engine.
+     */
+    inline Random &thread_instance()
+    {
+        auto &slot = _detail::this_thread_slot();
+        auto epoch = _detail::seed_epoch.load(std::memory_order_acquire);
+        if (slot.epoch != epoch)
+        {
+            slot.rng.seed(_detail::seed_value.load(std::memory_order_relaxed), slot.stream);
+            slot.epoch = epoch;
+        }
+        return slot.rng;
     }
 
-    // Bookkeeping functions:
     /*
-     * Initialize the random number generator.
-     *    If a is omitted or None, the current system time is used.
-     *    If a is an int, it is used directly.
+     * Pin the calling thread to a stream id, so its draws are reproducible regardless of thread start order.
      */
+    inline void set_thread_stream(std::uint64_t stream)
+    {
+        auto &slot = _detail::this_thread_slot();
+        slot.stream = stream;
+        slot.epoch = ~std::uint64_t(0);
+    }
+
+    namespace _detail
+    {
+
+        /*
+         * The instance behind the module-level functions.
+         *   Define RANDOMCPP_THREAD_LOCAL before including this header to give every thread its own engine
+         *   (see thread_instance()); otherwise all threads share one engine and must synchronize themselves.
+         */
+        inline Random &instance()
+        {
+#ifdef RANDOMCPP_THREAD_LOCAL
+            return thread_instance();
+#else
+            return global_instance();
+#endif
+        }
+
+    } // namespace _detail
+
+    // The module-level functions below are bound methods of a hidden Random instance, as in Python's random module.
+    //   Code that needs its own stream (e.g. one per thread) should create a Random instead.
+
+    // Bookkeeping functions:
     inline void seed(unsigned a)
     {
-        seed_value = a;
-        initialize();
+        _detail::reseed_threads(a);
+#ifndef RANDOMCPP_THREAD_LOCAL
+        _detail::global_instance().seed(a);
+#endif
     }
 
     inline void seed()
@@ -41,567 +5335,327 @@ namespace randomcpp
         seed(static_cast<unsigned>(std::time(0)));
     }
 
-    /*
-     * Reseed the random generator with the stored seed.
-     */
     inline void reset()
     {
-        initialize();
+        _detail::reseed_threads(_detail::seed_value.load(std::memory_order_relaxed));
+#ifndef RANDOMCPP_THREAD_LOCAL
+        _detail::global_instance().reset();
+#endif
     }
 
-    // Functions for integers:
-    /*
-     * Return a randomly selected element from range(start, stop, step).
-     */
-    inline int _randbelow(int n)
+    inline std::vector<std::uint8_t> getstate()
     {
-        return std::uniform_int_distribution<int>{0, n - 1}(gen);
+        return _detail::instance().getstate();
     }
 
-    inline int randrange(int start, int stop, int step = 1)
+    inline void setstate(std::span<std::uint8_t const> state)
     {
-        int width = stop - start;
-        if (step == 1 && width > 0)
-        {
-            return start + _randbelow(width);
-        }
-        if (step == 1)
-        {
-            throw std::range_error("empty range for randrange()");
-        }
-
-        int n;
-        if (step > 0)
-        {
-            n = (width + step - 1) / step;
-        }
-        else if (step < 0)
-        {
-            n = (width + step + 1) / step;
-        }
-        else
-        {
-            throw std::range_error("zero step for randrange()");
-        }
+        _detail::instance().setstate(state);
+    }
 
-        if (n <= 0)
-        {
-            throw std::range_error("empty range for randrange()");
-        }
+    // Functions for integers:
+    template <typename TInt, _detail::enable_if_integers<TInt> = 0>
+    inline TInt _randbelow(TInt n)
+    {
+        return _detail::instance()._randbelow(n);
+    }
 
-        return start + step * _randbelow(n);
+    template <typename TStart, typename TStop, typename TStep = int,
+              _detail::enable_if_integers<TStart, TStop, TStep> = 0>
+    inline std::common_type_t<TStart, TStop> randrange(TStart start, TStop stop, TStep step = 1)
+    {
+        return _detail::instance().randrange(start, stop, step);
     }
 
-    inline int randrange(int stop)
+    template <typename TInt, _detail::enable_if_integers<TInt> = 0>
+    inline TInt randrange(TInt stop)
     {
-        return randrange(0, stop);
+        return _detail::instance().randrange(stop);
     }
 
-    /*
-     * Return a random integer N such that a <= N <= b. Alias for randrange(a, b+1).
-     */
-    inline int randint(int a, int b)
+    template <typename TA, typename TB, _detail::enable_if_integers<TA, TB> = 0>
+    inline std::common_type_t<TA, TB> randint(TA a, TB b)
     {
-        return randrange(a, b + 1);
+        return _detail::instance().randint(a, b);
     }
 
     // Functions for sequences:
-    /*
-     * Return a random element from the non-empty sequence seq. If seq is empty, raises logic_error.
-     */
     template <typename TContainer>
     inline typename TContainer::value_type choice(TContainer const &container)
     {
-        auto begin(container.begin());
-        auto size(std::distance(begin, container.end()));
-        if (!size)
-        {
-            throw std::logic_error("Cannot choose from an empty sequence");
-        }
-        auto rand_index(randrange(size));
-        std::advance(begin, rand_index);
-        return *begin;
+        return _detail::instance().choice(container);
+    }
+
+    template <typename TContainer>
+    inline typename TContainer::value_type choice(TContainer const &container, DynamicWeightedSampler const &sampler)
+    {
+        return _detail::instance().choice(container, sampler);
     }
 
-    /*
-     * Return a random element from the non-empty sequence seq. If seq is empty, raises logic_error.
-     */
     template <typename T, std::size_t N>
     inline T choice(T const (&array)[N])
     {
-        if (!N)
-        {
-            throw std::logic_error("Cannot choose from an empty sequence");
-        }
-        auto rand_index(randrange(N));
-        return array[rand_index];
+        return _detail::instance().choice(array);
     }
 
-    /*
-     * Shuffle the sequence x in place.
-     *   Note that for even rather small len(x), the total number of permutations of x is larger than the period of most random number generators;
-     *   this implies that most permutations of a long sequence can never be generated.
-     */
     template <typename TContainer>
     inline void shuffle(TContainer *container)
     {
-        // #if __cplusplus >= 201103L
-        std::shuffle(container->begin(), container->end(), gen);
-        // #else
-        //     std::random_shuffle(container->begin(), container->end());
-        // #endif
+        _detail::instance().shuffle(container);
     }
 
-    /*
-     * Shuffle the sequence x in place.
-     *   Note that for even rather small len(x), the total number of permutations of x is larger than the period of most random number generators;
-     *   this implies that most permutations of a long sequence can never be generated.
-     */
     template <typename T, std::size_t N>
     inline void shuffle(T (*array)[N])
     {
-        for (unsigned i = N - 1; i > 0; i--)
-        {
-            unsigned j = randrange(i + 1);
-            std::swap((*array)[i], (*array)[j]);
-        }
+        _detail::instance().shuffle(array);
     }
 
-    namespace _detail
+    template <typename TContainer>
+    inline void shuffle(TContainer *container, cache_blocked_t)
     {
+        _detail::instance().shuffle(container, cache_blocked);
+    }
 
-        template <typename T>
-        void sample_dumb_array(T const *population, T *result, std::size_t n, std::size_t k)
-        {
-            std::set<unsigned> selected;
-            for (unsigned i = 0; i < k; i++)
-            {
-                unsigned j = randrange(n);
-                while (!selected.insert(j).second)
-                {
-                    j = randrange(n);
-                }
-                *(result + i) = *(population + j);
-            }
-        }
-
-        template <typename T>
-        struct has_resize
-        {
-            template <typename U, void (U::*)(std::size_t)>
-            struct resize_signature
-            {
-            };
-
-            template <typename U>
-            static char Test(resize_signature<U, &U::resize> *);
-
-
-            template <typename U>
-            static int Test(...);
-
-            static inline const bool value = sizeof(Test<T>(0)) == sizeof(char);
-            
-        /* Another optional implementation */
-        // private: 
-        //     template <typename U>
-        //     static auto Test(int) -> decltype(std::declval<U>().resize(std::declval<std::size_t>()), std::true_type{});
-
-        //     template <typename U>
-        //     static std::false_type Test(...);
-
-        // public:
-        //     static constexpr bool value = decltype(Test<T>(0))::value;
-        };
-
-    } // namespace _detail
+    template <typename T, std::size_t N>
+    inline void shuffle(T (*array)[N], cache_blocked_t)
+    {
+        _detail::instance().shuffle(array, cache_blocked);
+    }
 
-    /*
-     * Return a k length list of unique elements chosen from the population sequence or set. Used for random sampling without replacement.
-     *   Returns a new list containing elements from the population while leaving the original population unchanged.
-     *   The resulting list is in selection order so that all sub-slices will also be valid random samples.
-     *   This allows raffle winners (the sample) to be partitioned into grand prize and second place winners (the subslices).
-     */
-    template <typename TPopulation,
-              typename std::enable_if<_detail::has_resize<TPopulation>::value, int>::type = 0>
-    inline TPopulation sample(TPopulation const &population, std::size_t k)
+    template <typename TContainer>
+    inline void parallel_shuffle(TContainer *container, unsigned threads = 0)
     {
-        std::set<unsigned> selected;
-        TPopulation result;
-        result.resize(k);
-        auto size(std::distance(population.begin(), population.end()));
-        auto result_itr(result.begin());
-        auto population_itr(population.begin());
-        for (unsigned i = 0; i < k; i++)
-        {
-            unsigned j = randrange(size);
-            while (!selected.insert(j).second)
-            {
-                j = randrange(size);
-            }
-            population_itr = population.begin();
-            std::advance(population_itr, j);
-            *result_itr = *population_itr;
-            std::advance(result_itr, 1);
-        }
-        return std::move(result);
+        _detail::instance().parallel_shuffle(container, threads);
     }
 
-    template <typename TPopulation,
-              typename std::enable_if<!_detail::has_resize<TPopulation>::value, int>::type = 0>
+    template <typename TPopulation>
     inline TPopulation sample(TPopulation const &population, std::size_t k)
     {
-        std::set<unsigned> selected;
-        TPopulation result;
-        auto size(std::distance(population.begin(), population.end()));
-        auto result_itr(result.begin());
-        auto population_itr(population.begin());
-        for (unsigned i = 0; i < k; i++)
-        {
-            unsigned j = randrange(size);
-            while (!selected.insert(j).second)
-            {
-                j = randrange(size);
-            }
-            population_itr = population.begin();
-            std::advance(population_itr, j);
-            result.insert(*population_itr);
-        }
-        return std::move(result);
+        return _detail::instance().sample(population, k);
     }
 
     template <typename T, std::size_t N, std::size_t K>
     inline void sample(T const (&population)[N], T (*result)[K])
     {
-        _detail::sample_dumb_array<T>(&population[0], &(*result)[0], N, K);
+        _detail::instance().sample(population, result);
     }
 
     template <typename T, std::size_t N, std::size_t K>
     inline void sample(std::array<T, N> const &population, std::array<T, K> *result)
     {
-        _detail::sample_dumb_array<T>(population.data(), result->data(), N, K);
+        _detail::instance().sample(population, result);
     }
 
-    // The following functions generate specific real-valued distributions.
-    //   Function parameters are named after the corresponding variables in the distribution’s equation,
-    //   as used in common mathematical practice; most of these equations can be found in any statistics text.
+    template <typename TContainer>
+    inline std::vector<typename TContainer::value_type> choices(TContainer const &population, std::size_t k = 1)
+    {
+        return _detail::instance().choices(population, k);
+    }
 
-    /*
-     * Return the next random floating point number in the range [0.0, 1.0).
-     */
-    inline float random()
+    template <typename TContainer, typename TWeights,
+              typename std::enable_if<!std::is_arithmetic<TWeights>::value, int>::type = 0>
+    inline std::vector<typename TContainer::value_type> choices(TContainer const &population, TWeights const &weights, std::size_t k = 1)
     {
-        return std::uniform_real_distribution<float>{0.0f, 1.0f}(gen);
+        return _detail::instance().choices(population, weights, k);
     }
 
-    /*
-     * Return a random floating point number N such that a <= N <= b for a <= b and b <= N <= a for b < a.
-     *   The end-point value b may or may not be included in the range depending on floating-point rounding in the equation a + (b-a) * random().
-     */
-    inline float uniform(float a, float b)
+    template <typename TContainer, typename TWeights>
+    inline std::vector<typename TContainer::value_type> choices(TContainer const &population, cum_weights_t, TWeights const &cum, std::size_t k = 1)
     {
-        return a + (b - a) * random();
+        return _detail::instance().choices(population, cum_weights, cum, k);
     }
 
-    /*
-     * Return a random floating point number N such that low <= N <= high and with the specified mode between those bounds.
-     *   The low and high bounds default to zero and one.
-     *   The mode argument defaults to the midpoint between the bounds, giving a symmetric distribution.
-     */
+    template <typename TContainer>
+    inline std::vector<typename TContainer::value_type> choices(TContainer const &population, AliasTable const &table, std::size_t k = 1)
+    {
+        return _detail::instance().choices(population, table, k);
+    }
 
-    inline float triangular(float low = 0.0, float high = 1.0, float mode = 0.5)
+    template <typename TContainer, typename TWeights>
+    inline std::vector<typename TContainer::value_type> weighted_sample(TContainer const &population, TWeights const &weights, std::size_t k)
     {
-        auto u(random());
-        auto &c = mode;
-        if (u > c)
-        {
-            u = 1.0f - u;
-            c = 1.0f - c;
-            std::swap(low, high);
-        }
-        return low + (high - low) * std::pow((u * c), 0.5);
+        return _detail::instance().weighted_sample(population, weights, k);
     }
 
-    /*
-     * Beta distribution. Conditions on the parameters are alpha > 0 and beta > 0. Returned values range between 0 and 1.
-     */
-    inline float gammavariate(float alpha, float beta);
-    inline float betavariate(float alpha, float beta)
+    template <typename TContainer, typename TWeights>
+    inline std::vector<typename TContainer::value_type> parallel_weighted_sample(TContainer const &population, TWeights const &weights, std::size_t k, unsigned threads = 0)
     {
-        auto y = gammavariate(alpha, 1.0f);
-        if (y != 0.0f)
-        {
-            y /= y + gammavariate(beta, 1.0f);
-        }
-        return y;
+        return _detail::instance().parallel_weighted_sample(population, weights, k, threads);
     }
 
-    /*
-     * Exponential distribution. lambda is 1.0 divided by the desired mean. It should be nonzero.
-     *   Returned values range from 0 to positive infinity if lambda is positive,
-     *   and from negative infinity to 0 if lambda is negative.
-     */
-    inline float expovariate(float lambda)
+    // Real-valued distributions:
+    template <typename TReal = float>
+    inline TReal random()
     {
-        float u;
-        do
-        {
-            u = random();
-        } while (u <= 1e-7);
-        return -std::log(u) / lambda;
+        return _detail::instance().random<TReal>();
     }
 
-    /*
-     * Gamma distribution. (Not the gamma function!) Conditions on the parameters are alpha > 0 and beta > 0.
-     *   The probability distribution function is:
-     *
-     *              x ** (alpha - 1) * math.exp(-x / beta)
-     *    pdf(x) =  --------------------------------------
-     *                math.gamma(alpha) * beta ** alpha
-     */
+    inline double random_double()
+    {
+        return _detail::instance().random_double();
+    }
 
-    inline float gammavariate(float alpha, float beta)
+    template <typename TReal = float>
+    inline TReal uniform(std::type_identity_t<TReal> a, std::type_identity_t<TReal> b)
     {
-        if (alpha < 0.0f || beta < 0.0f)
-        {
-            throw std::invalid_argument("gammavariate: alpha and beta must be > 0.0");
-        }
-        if (alpha > 1.0)
-        {
-            // Uses R.C.H. Cheng, "The generation of Gamma
-            // variables with non-integral shape parameters",
-            // Applied Statistics, (1977), 26, No. 1, p71-74
-            float ainv = std::sqrt(2.0f * alpha - 1.0f);
-            float bbb = alpha - static_cast<float>(std::log(4));
-            float ccc = alpha + ainv;
+        return _detail::instance().uniform<TReal>(a, b);
+    }
 
-            while (true)
-            {
-                float u1 = random();
-                if (1e-7 < u1 < .9999999)
-                {
-                    continue;
-                }
-                float u2 = 1.0f - random();
-                float v = std::log(u1 / (1.0f - u1)) / ainv;
-                float x = alpha * std::exp(v);
-                float z = u1 * u1 * u2;
-                float r = bbb + ccc * v - x;
-                if (r + SG_MAGICCONST - 4.5 * z >= 0.0 or r >= std::log(z))
-                {
-                    return x * beta;
-                }
-            }
-        }
-        else if (alpha == 1.0)
-        {
-            // expovariate(1)
-            float u = random();
-            while (u <= 1e-7)
-            {
-                u = random();
-            }
-            return -std::log(u) * beta;
-        }
-        else /* alpha is between 0 and 1 (exclusive) */
-        {
-            // Uses ALGORITHM GS of Statistical Computing - Kennedy & Gentle
-            while (true)
-            {
-                float u = random();
-                float b = (M_E + alpha) / M_E;
-                float p = b * u;
-                float x;
-                if (p <= 1.0)
-                {
-                    x = std::pow(p, 1.0f / alpha);
-                }
-                else
-                {
-                    x = -std::log((b - p) / alpha);
-                }
-                float u1 = random();
-                if (p > 1.0)
-                {
-                    if (u1 <= std::pow(x, alpha - 1.0f))
-                    {
-                        break;
-                    }
-                }
-                else if (u1 <= std::exp(-x))
-                {
-                    break;
-                }
-                return x * beta;
-            }
-        }
-        return 0.0;
+    template <typename TReal = float>
+    inline TReal triangular(std::type_identity_t<TReal> low = 0, std::type_identity_t<TReal> high = 1, std::type_identity_t<TReal> mode = TReal(0.5))
+    {
+        return _detail::instance().triangular<TReal>(low, high, mode);
     }
 
-    /*
-     * Gaussian distribution. mu is the mean, and sigma is the standard deviation.
-     *   This is slightly faster than the normalvariate() function defined below.
-     */
+    template <typename TReal = float>
+    inline TReal betavariate(std::type_identity_t<TReal> alpha, std::type_identity_t<TReal> beta)
+    {
+        return _detail::instance().betavariate<TReal>(alpha, beta);
+    }
 
-    inline float gauss(float mu, float sigma)
+    template <typename TContainer>
+    inline std::vector<typename TContainer::value_type> dirichletvariate(TContainer const &alphas)
     {
-        std::normal_distribution<float> dist(mu, sigma);
-        return dist(gen);
+        return _detail::instance().dirichletvariate(alphas);
     }
 
-    /*
-     * Normal distribution. mu is the mean, and sigma is the standard deviation.
-     */
+    template <typename TContainer>
+    inline void dirichletvariate(TContainer const &alphas, std::span<typename TContainer::value_type> out)
+    {
+        _detail::instance().dirichletvariate(alphas, out);
+    }
 
-    inline float normalvariate(float mu, float sigma)
+    template <typename TReal = float>
+    inline TReal expovariate(std::type_identity_t<TReal> lambda)
     {
-        float z;
-        while (true)
-        {
-            float u1 = random();
-            float u2 = 1.0f - random();
-            z = NV_MAGICCONST * (u1 - 0.5f) / u2;
-            float zz = z * z / 4.0f;
-            if (zz <= -std::log(u2))
-            {
-                break;
-            }
-        }
-        return mu + z * sigma;
+        return _detail::instance().expovariate<TReal>(lambda);
     }
 
-    /*
-     * Circular data distribution. mu is the mean angle, expressed in radians between 0 and 2*pi,
-     *   and kappa is the concentration parameter, which must be greater than or equal to zero.
-     *   If kappa is equal to zero, this distribution reduces to a uniform random angle over the range 0 to 2*pi.
-     */
+    template <typename TReal = float>
+    inline TReal expovariate(std::type_identity_t<TReal> lambda, ziggurat_t)
+    {
+        return _detail::instance().expovariate<TReal>(lambda, ziggurat);
+    }
 
-    inline float vonmisesvariate(float mu, float kappa)
+    template <typename TReal = float>
+    inline TReal gammavariate(std::type_identity_t<TReal> alpha, std::type_identity_t<TReal> beta)
     {
-        if (kappa <= 1e-6)
-        {
-            return 2.0f * M_PI * random();
-        }
+        return _detail::instance().gammavariate<TReal>(alpha, beta);
+    }
 
-        float a = 1.0f + std::sqrt(1.0f + 4.0f * kappa * kappa);
-        float b = (a - std::sqrt(2.0f * a)) / (2.0f * kappa);
-        float r = (1.0f + b * b) / (2.0f * b);
+    template <typename TReal = float>
+    inline TReal gauss(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> sigma)
+    {
+        return _detail::instance().gauss<TReal>(mu, sigma);
+    }
 
-        float f;
-        while (true)
-        {
-            float u1 = random();
+    template <typename TReal = float>
+    inline TReal gauss(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> sigma, ziggurat_t)
+    {
+        return _detail::instance().gauss<TReal>(mu, sigma, ziggurat);
+    }
 
-            float z = std::cos(M_PI * u1);
-            f = (1.0f + r * z) / (r + z);
-            float c = kappa * (r - f);
-            float u2 = random();
+    template <typename TReal = float>
+    inline TReal normalvariate(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> sigma)
+    {
+        return _detail::instance().normalvariate<TReal>(mu, sigma);
+    }
 
-            if (u2 < c * (2.0f - c) || u2 <= c * std::exp(1.0f - c))
-            {
-                break;
-            }
-        }
+    template <typename TReal = float>
+    inline TReal normalvariate(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> sigma, ziggurat_t)
+    {
+        return _detail::instance().normalvariate<TReal>(mu, sigma, ziggurat);
+    }
 
-        float u3 = random();
-        float theta;
-        if (u3 > 0.5f)
-        {
-            theta = std::fmod(mu, 2.0f * M_PI) + std::acos(f);
-        }
-        else
-        {
-            theta = std::fmod(mu, 2.0f * M_PI) - std::acos(f);
-        }
-        return theta;
+    template <typename TReal = float>
+    inline TReal vonmisesvariate(std::type_identity_t<TReal> mu, std::type_identity_t<TReal> kappa)
+    {
+        return _detail::instance().vonmisesvariate<TReal>(mu, kappa);
     }
 
-    /*
-     * Pareto distribution. alpha is the shape parameter.
-     */
+    template <typename TReal = float>
+    inline TReal paretovariate(std::type_identity_t<TReal> alpha)
+    {
+        return _detail::instance().paretovariate<TReal>(alpha);
+    }
 
-    inline float paretovariate(float alpha)
+    template <typename TReal = float>
+    inline TReal weibullvariate(std::type_identity_t<TReal> alpha, std::type_identity_t<TReal> beta)
     {
-        float u = 1.0f - random();
-        return 1.0f / std::pow(u, (1.0f / alpha));
+        return _detail::instance().weibullvariate<TReal>(alpha, beta);
     }
 
-    /*
-     * Weibull distribution. alpha is the scale parameter and beta is the shape parameter.
-     */
+    // Bulk versions:
+    inline void random(std::span<float> out)
+    {
+        _detail::instance().random(out);
+    }
 
-    inline float weibullvariate(float alpha, float beta)
+    inline void random(std::span<double> out)
     {
-        float u = 1.0f - random();
-        return alpha * std::pow(-std::log(u), 1.0f / beta);
+        _detail::instance().random(out);
     }
 
-    // Other functions
-    /*
-     * Return value has a <probability_> chance of being true
-     */
-    inline bool probability(float probability_)
+    inline void uniform(std::span<float> out, float a, float b)
     {
-        float r = uniform(0.0f, 1.0f);
-        return r <= probability_;
+        _detail::instance().uniform(out, a, b);
     }
 
-    /*
-     * Return a k length list of unique (or not) elements chosen from the range.
-     * If the range is empty, raises a range_error.
-     * If sampling without replacement, the algorithm to use is determined by the parameter `k`:
-     * - If k << n (k < n/10), the hash-based Fisher-Yates shuffle is used.
-     * - Otherweise, the array-based Fisher-Yates shuffle is used.
-     */
-    inline std::vector<int> sample(int a, int b, unsigned k, bool unique = false)
+    inline void uniform(std::span<double> out, double a, double b)
     {
-        if (unique && (b - a) + 1 < k)
-        {
-            throw std::range_error("random vector unique but range is less than count");
-        }
+        _detail::instance().uniform(out, a, b);
+    }
 
-        std::vector<int> rand_is;
-        if (!unique)
-        {
-            for (unsigned i = 0; i < k; i++)
-            {
-                int rand_i = randint(a, b);
-                rand_is.push_back(rand_i);
-            }
-        }
-        else
-        {
-            int n = b - a;
-            if (k < n / 10)
-            {
-                std::unordered_map<int, int> map{};
-                for (int i = 0; i < k; ++i)
-                {
-                    int j = randint(i, n - 1);
+    inline void expovariate(std::span<float> out, float lambda)
+    {
+        _detail::instance().expovariate(out, lambda);
+    }
 
-                    int valJ = (map.count(j) ? map[j] : j);
-                    int valI = (map.count(n - 1) ? map[n - 1] : (n - 1));
+    inline void expovariate(std::span<double> out, double lambda)
+    {
+        _detail::instance().expovariate(out, lambda);
+    }
 
-                    rand_is.push_back(a + valJ);
+    inline void gauss(std::span<float> out, float mu, float sigma)
+    {
+        _detail::instance().gauss(out, mu, sigma);
+    }
 
-                    map[j] = valI;
+    inline void gauss(std::span<double> out, double mu, double sigma)
+    {
+        _detail::instance().gauss(out, mu, sigma);
+    }
 
-                    --n;
-                }
-            }
-            else
-            {
-                std::vector<int> all;
-                all.reserve(n);
-                for (int i = a; i <= b; ++i)
-                {
-                    all.push_back(i);
-                }
-                shuffle(&all);
-                std::copy(all.begin(), all.begin() + k, std::back_inserter(rand_is));
-            }
-        }
-        return rand_is;
+    inline void gauss(std::span<float> out, float mu, float sigma, ziggurat_t)
+    {
+        _detail::instance().gauss(out, mu, sigma, ziggurat);
+    }
+
+    inline void gauss(std::span<double> out, double mu, double sigma, ziggurat_t)
+    {
+        _detail::instance().gauss(out, mu, sigma, ziggurat);
+    }
+
+    inline void expovariate(std::span<float> out, float lambda, ziggurat_t)
+    {
+        _detail::instance().expovariate(out, lambda, ziggurat);
+    }
+
+    inline void expovariate(std::span<double> out, double lambda, ziggurat_t)
+    {
+        _detail::instance().expovariate(out, lambda, ziggurat);
+    }
+
+    // Other functions
+    inline bool probability(float probability_)
+    {
+        return _detail::instance().probability(probability_);
+    }
+
+    template <typename TA, typename TB, _detail::enable_if_integers<TA, TB> = 0>
+    inline std::vector<std::common_type_t<TA, TB>> sample(TA a, TB b, std::size_t k, bool unique = false)
+    {
+        return _detail::instance().sample(a, b, k, unique);
     }
 
 } // namespace randomcpp
@@ -0,0 +1,377 @@
+#include <gtest/gtest.h>
+
+#include <randomcpp.hpp>
+#include <vector>
+#include <algorithm>
+
+class RandomEnginesTest : public ::testing::Test
+{
+};
+
+// Tests every engine BasicRandom is meant to work with: the engines in this header and the standard ones.
+template <typename TEngine>
+class EveryEngineTest : public ::testing::Test
+{
+protected:
+   // Whether long_jump() and split(k) compile for this engine; for the others they are a static_assert.
+   static constexpr bool can_long_jump = randomcpp::_detail::has_long_jump<TEngine>::value ||
+                                         randomcpp::_detail::is_mersenne_twister<TEngine>::value;
+};
+
+#ifdef __SIZEOF_INT128__
+#define RANDOMCPP_TEST_PCG64 randomcpp::pcg64,
+#else
+#define RANDOMCPP_TEST_PCG64
+#endif
+
+using Engines = ::testing::Types<std::mt19937, std::mt19937_64, std::minstd_rand, randomcpp::splitmix64, randomcpp::xoshiro256pp,
+                                 randomcpp::xoshiro128p, randomcpp::pcg32, RANDOMCPP_TEST_PCG64 randomcpp::philox4x32,
+                                 randomcpp::sfmt19937>;
+TYPED_TEST_SUITE(EveryEngineTest, Engines);
+
+TYPED_TEST(EveryEngineTest, DiscardMatchesStepping)
+{
+   for (unsigned long long skip : {0ULL, 1ULL, 3ULL, 4ULL, 5ULL, 1000ULL, 100000ULL})
+   {
+      TypeParam stepped(7), jumped(7);
+      stepped();
+      jumped();
+      for (unsigned long long i = 0; i < skip; ++i)
+      {
+         stepped();
+      }
+      jumped.discard(skip);
+      EXPECT_TRUE(stepped == jumped);
+      EXPECT_EQ(stepped(), jumped());
+   }
+}
+
+TYPED_TEST(EveryEngineTest, JumpMatchesDiscard)
+{
+   namespace d = randomcpp::_detail;
+   if constexpr (d::is_mersenne_twister<TypeParam>::value)
+   {
+      // The polynomial jump itself, below the distance where jump() switches to it.
+      constexpr unsigned long long n = TypeParam::state_size;
+      for (unsigned long long z : {n + 1, n + 76, 2 * n, 5000ULL})
+      {
+         TypeParam jumped(9), discarded(9);
+         jumped();
+         discarded();
+         d::mt_jump(&jumped, d::gf2_pow_x_mod(z - n - 1, d::mt_polynomial<TypeParam>()));
+         discarded.discard(z);
+         for (int i = 0; i < 1000; ++i)
+         {
+            ASSERT_EQ(jumped(), discarded()) << z;
+         }
+      }
+   }
+
+   for (unsigned long long n : {1ULL, 624ULL, 12345ULL, (1ULL << 20) + 777})
+   {
+      randomcpp::BasicRandom<TypeParam> jumped(5), discarded(5);
+      jumped();
+      discarded();
+      jumped.jump(n);
+      discarded.engine().discard(n);
+      for (int i = 0; i < 1000; ++i)
+      {
+         ASSERT_EQ(jumped(), discarded()) << n;
+      }
+   }
+}
+
+TYPED_TEST(EveryEngineTest, SplitMatchesSerialRun)
+{
+   for (unsigned long long n : {1001ULL, 1ULL << 20})
+   {
+      randomcpp::BasicRandom<TypeParam> serial(11), parallel(11);
+      auto workers = parallel.split(3, n);
+      ASSERT_EQ(workers.size(), 3u);
+      for (auto &worker : workers)
+      {
+         for (unsigned long long i = 0; i < n; ++i)
+         {
+            ASSERT_EQ(worker(), serial()) << n;
+         }
+      }
+      EXPECT_EQ(parallel(), serial());
+   }
+}
+
+TYPED_TEST(EveryEngineTest, SplitStreamsDiffer)
+{
+   if constexpr (TestFixture::can_long_jump)
+   {
+      randomcpp::BasicRandom<TypeParam> rng(1);
+      auto streams = rng.split(4);
+      std::vector<typename TypeParam::result_type> first;
+      for (auto &stream : streams)
+      {
+         first.push_back(stream());
+      }
+      first.push_back(rng());
+      std::sort(first.begin(), first.end());
+      EXPECT_EQ(std::adjacent_find(first.begin(), first.end()), first.end());
+   }
+   else
+   {
+      GTEST_SKIP() << "no long jump: split(k) and long_jump() do not compile for this engine";
+   }
+}
+
+TYPED_TEST(EveryEngineTest, BasicRandomWorks)
+{
+   randomcpp::BasicRandom<TypeParam> rng(1), same(1);
+   for (unsigned i = 0; i < 200; ++i)
+   {
+      int rand_i = rng.randint(-5, 5);
+      EXPECT_GE(rand_i, -5);
+      EXPECT_LE(rand_i, 5);
+      float rand_f = rng.random();
+      EXPECT_GE(rand_f, 0.0f);
+      EXPECT_LT(rand_f, 1.0f);
+      EXPECT_EQ(rand_i, same.randint(-5, 5));
+      EXPECT_EQ(rand_f, same.random());
+   }
+
+   std::vector<int> sequence = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+   rng.shuffle(&sequence);
+   EXPECT_TRUE(std::is_permutation(sequence.begin(), sequence.end(), std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9}.begin()));
+   EXPECT_EQ(rng.sample(sequence, 4).size(), 4);
+   EXPECT_GT(rng.gammavariate(2.5f, 1.0f), 0.0f);
+
+   rng.seed(3);
+   same.seed(3);
+   EXPECT_EQ(rng.gauss(0.0f, 1.0f), same.gauss(0.0f, 1.0f));
+}
+
+TYPED_TEST(EveryEngineTest, StateRoundTrips)
+{
+   randomcpp::BasicRandom<TypeParam> rng(3, 9);
+   for (unsigned i = 0; i < 1001; ++i)
+   {
+      rng();
+   }
+   auto state = rng.getstate();
+   ASSERT_GE(state.size(), 24u);
+   EXPECT_EQ(state[0], 'R');
+   EXPECT_EQ(state[2], 1);
+
+   randomcpp::BasicRandom<TypeParam> restored(1);
+   restored.setstate(state);
+   for (unsigned i = 0; i < 2000; ++i)
+   {
+      ASSERT_EQ(restored(), rng());
+   }
+   restored.reset();
+   rng.reset();
+   EXPECT_EQ(restored(), rng());
+}
+
+// Known-answer tests against the reference implementations
+TEST_F(RandomEnginesTest, Pcg32ReferenceOutput)
+{
+   randomcpp::pcg32 gen(42, 54);
+   std::vector<std::uint32_t> expected = {0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e};
+   for (auto value : expected)
+   {
+      EXPECT_EQ(gen(), value);
+   }
+}
+
+TEST_F(RandomEnginesTest, SplitMix64ReferenceOutput)
+{
+   randomcpp::splitmix64 gen(1234567);
+   EXPECT_EQ(gen(), 6457827717110365317ULL);
+   EXPECT_EQ(gen(), 3203168211198807973ULL);
+   EXPECT_EQ(gen(), 9817491932198370423ULL);
+}
+
+TEST_F(RandomEnginesTest, Philox4x32ReferenceOutput)
+{
+   auto block = randomcpp::_detail::philox4x32_10({0, 0, 0, 0}, {0, 0});
+   EXPECT_EQ(block, (std::array<std::uint32_t, 4>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+   block = randomcpp::_detail::philox4x32_10({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0});
+   EXPECT_EQ(block, (std::array<std::uint32_t, 4>{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+
+   randomcpp::philox4x32 gen(0);
+   EXPECT_EQ(gen(), 0x6627e8d5u);
+}
+
+TEST_F(RandomEnginesTest, Threefry2x64ReferenceOutput)
+{
+   auto block = randomcpp::_detail::threefry2x64_20({0, 0}, {0, 0});
+   EXPECT_EQ(block, (std::array<std::uint64_t, 2>{0xc2b6e3a8c2c69865, 0x6f81ed42f350084d}));
+}
+
+// The reference jump constants are x^(2^128) and x^(2^64) modulo the characteristic polynomials found by Berlekamp-Massey
+TEST_F(RandomEnginesTest, XoshiroJumpPolynomials)
+{
+   namespace d = randomcpp::_detail;
+   auto const &p256 = d::xoshiro_polynomial<d::xoshiro256_state>();
+   EXPECT_EQ(d::gf2_degree(p256), 256u);
+   d::gf2_poly q = {2};
+   for (int i = 0; i < 128; ++i)
+   {
+      q = d::gf2_square_mod(q, p256);
+   }
+   q.resize(4);
+   EXPECT_EQ(q, (d::gf2_poly{0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c}));
+
+   auto const &p128 = d::xoshiro_polynomial<d::xoshiro128_state>();
+   EXPECT_EQ(d::gf2_degree(p128), 128u);
+   q = {2};
+   for (int i = 0; i < 64; ++i)
+   {
+      q = d::gf2_square_mod(q, p128);
+   }
+   q.resize(2);
+   EXPECT_EQ(q, (d::gf2_poly{0xf542d2d38764000b, 0x77f2db5b6fa035c3}));
+
+   randomcpp::xoshiro128p jumped(3), discarded(3);
+   jumped.jump();
+   discarded.discard(~0ULL);
+   discarded();
+   EXPECT_TRUE(jumped == discarded);
+}
+
+TEST_F(RandomEnginesTest, Sfmt19937JumpMatchesStepping)
+{
+   EXPECT_EQ(randomcpp::_detail::gf2_degree(randomcpp::_detail::sfmt::polynomial()), 19968u);
+   for (unsigned seed : {1u, 4357u})
+   {
+      for (unsigned long long n : {(1ULL << 26) + 5, 3ULL << 25})
+      {
+         randomcpp::sfmt19937 jumped(seed), stepped(seed);
+         jumped();
+         stepped();
+         jumped.discard(n);
+         for (unsigned long long i = 0; i < n; ++i)
+         {
+            stepped();
+         }
+         ASSERT_TRUE(jumped == stepped) << n;
+      }
+   }
+}
+
+TEST_F(RandomEnginesTest, StreamsDiffer)
+{
+   randomcpp::BasicRandom<randomcpp::xoshiro256pp> stream_1(1, 1), stream_2(1, 2);
+   EXPECT_NE(stream_1(), stream_2());
+}
+
+TEST_F(RandomEnginesTest, Sfmt19937ReferenceOutput)
+{
+   // init_gen_rand(1234) from the reference SFMT.19937.out.txt
+   randomcpp::sfmt19937 gen(1234);
+   std::vector<std::uint32_t> expected = {3440181298u, 1564997079u, 1510669302u, 2930277156u, 1452439940u};
+   for (auto value : expected)
+   {
+      EXPECT_EQ(gen(), value);
+   }
+}
+
+TEST_F(RandomEnginesTest, Sfmt19937SimdMatchesScalar)
+{
+   randomcpp::sfmt19937 gen(99);
+   std::vector<std::uint32_t> state(randomcpp::sfmt19937::state_size);
+   gen.fill(state.data(), state.size());
+   auto scalar(state);
+   randomcpp::_detail::sfmt::gen_rand_all_scalar(scalar.data());
+   std::vector<std::uint32_t> simd(state.size());
+   gen.fill(simd.data(), simd.size());
+   EXPECT_EQ(scalar, simd);
+}
+
+TEST_F(RandomEnginesTest, Sfmt19937BlockFillMatchesSingleDraws)
+{
+   randomcpp::sfmt19937 single(5), block(5);
+   std::vector<std::uint32_t> words(2000);
+   block();
+   single();
+   block.fill(words.data(), words.size());
+   for (auto word : words)
+   {
+      EXPECT_EQ(word, single());
+   }
+
+   std::vector<std::uint64_t> wide(700);
+   block.fill(wide.data(), wide.size());
+   for (auto word : wide)
+   {
+      std::uint64_t lo = single();
+      EXPECT_EQ(word, (std::uint64_t(single()) << 32) | lo);
+   }
+
+   std::vector<double> reals(5000);
+   block.fill(reals.data(), reals.size());
+   double sum = 0.0;
+   for (auto r : reals)
+   {
+      EXPECT_GE(r, 0.0);
+      EXPECT_LT(r, 1.0);
+      sum += r;
+   }
+   EXPECT_NEAR(sum / reals.size(), 0.5, 0.02);
+}
+
+TEST_F(RandomEnginesTest, CounterMatchesPhiloxStream)
+{
+   randomcpp::BasicRandom<randomcpp::philox4x32> rng(77), same(77);
+   std::vector<float> uniforms(1001), normals(1000);
+   rng.random(uniforms);
+   same.gauss(normals, 1.0f, 2.0f);
+   for (std::uint64_t i = 0; i < uniforms.size(); ++i)
+   {
+      ASSERT_EQ(randomcpp::counter::uniform(77, i), uniforms[i]);
+   }
+   for (std::uint64_t i = 0; i < normals.size(); ++i)
+   {
+      ASSERT_EQ(randomcpp::counter::gauss(77, i, 1.0f, 2.0f), normals[i]);
+   }
+
+   randomcpp::philox4x32 gen(77);
+   gen.discard(123457);
+   EXPECT_EQ(randomcpp::counter::bits(77, 123457), gen());
+}
+
+TEST_F(RandomEnginesTest, CounterBlocksMatchScalar)
+{
+   std::vector<std::uint32_t> words(613);
+   std::vector<float> uniforms(613), normals(613), threefry_normals(613);
+   for (std::uint64_t offset : {0ULL, 1ULL, 6ULL, 1ULL << 40})
+   {
+      randomcpp::counter::bits(5, offset, words, randomcpp::counter::threefry);
+      randomcpp::counter::uniform(5, offset, uniforms);
+      randomcpp::counter::gauss(5, offset, normals, -1.0f, 0.5f);
+      randomcpp::counter::gauss(5, offset, threefry_normals, 0.0f, 1.0f, randomcpp::counter::threefry);
+      for (std::uint64_t i = 0; i < words.size(); ++i)
+      {
+         ASSERT_EQ(words[i], randomcpp::counter::bits(5, offset + i, randomcpp::counter::threefry));
+         ASSERT_EQ(uniforms[i], randomcpp::counter::uniform(5, offset + i));
+         ASSERT_EQ(normals[i], randomcpp::counter::gauss(5, offset + i, -1.0f, 0.5f));
+         ASSERT_EQ(threefry_normals[i], randomcpp::counter::gauss(5, offset + i, 0.0f, 1.0f, randomcpp::counter::threefry));
+      }
+   }
+   EXPECT_NE(randomcpp::counter::bits(5, 0), randomcpp::counter::bits(5, 0, randomcpp::counter::threefry));
+   EXPECT_NE(randomcpp::counter::bits(5, 0), randomcpp::counter::bits(6, 0));
+}
+
+TEST_F(RandomEnginesTest, SetStateRejectsForeignState)
+{
+   randomcpp::Random mt(1);
+   randomcpp::BasicRandom<randomcpp::pcg32> pcg(1);
+   auto state = mt.getstate();
+   // The word count depends on the standard library's textual mt19937 state, so check it against the header only.
+   ASSERT_GT(state.size(), 24u);
+   EXPECT_EQ(state[4], 4);
+   EXPECT_EQ(randomcpp::_detail::load_le(&state[12], 4), (state.size() - 24) / 4);
+   EXPECT_THROW(pcg.setstate(state), std::invalid_argument);
+   state.pop_back();
+   EXPECT_THROW(mt.setstate(state), std::invalid_argument);
+   state[2] = 2;
+   EXPECT_THROW(mt.setstate(state), std::invalid_argument);
+   EXPECT_THROW(mt.setstate({}), std::invalid_argument);
+}
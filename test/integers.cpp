@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 
 #include <randomcpp.hpp>
+#include <vector>
+#include <set>
+#include <limits>
+#include <cstdint>
 
 class RandomIntegersTest : public ::testing::Test
 {
@@ -85,4 +89,205 @@ TEST_F(RandomIntegersTest, RepeatRandomIntegersNotEqual)
    {
       EXPECT_NE(randomcpp::randint(0, 1000), randomcpp::randint(0, 1000));
    }
-}
\ No newline at end of file
+}
+
+TEST_F(RandomIntegersTest, RandBelowIsUniform)
+{
+   std::vector<int> counts(7, 0);
+   for (unsigned i = 0; i < 70000; ++i)
+   {
+      ++counts[randomcpp::_randbelow(7)];
+   }
+   for (auto count : counts)
+   {
+      EXPECT_NEAR(count, 10000, 400);
+   }
+   EXPECT_EQ(randomcpp::_randbelow(1), 0);
+   EXPECT_THROW(randomcpp::_randbelow(0), std::range_error);
+   EXPECT_THROW(randomcpp::_randbelow(-5), std::range_error);
+   EXPECT_THROW(randomcpp::_randbelow(std::uint64_t(0)), std::range_error);
+}
+
+TEST_F(RandomIntegersTest, BoundedIsUnbiasedForWideRanges)
+{
+   // Modulo reduction of a 32-bit word over 3 * 2^30 would land below 2^30 half the time instead of a third.
+   randomcpp::Random rng(1);
+   unsigned low = 0;
+   for (unsigned i = 0; i < 30000; ++i)
+   {
+      std::uint32_t value = randomcpp::_detail::bounded32(rng, 0xC0000000u);
+      EXPECT_LT(value, 0xC0000000u);
+      low += value < 0x40000000u;
+   }
+   EXPECT_NEAR(low, 10000, 400);
+}
+
+TEST_F(RandomIntegersTest, RandomInteger64InsideWideRange)
+{
+   std::int64_t const low = std::numeric_limits<std::int64_t>::min() / 2 - 7;
+   std::int64_t const high = std::numeric_limits<std::int64_t>::max() / 2 + 7;
+   bool below_zero = false, above_int = false;
+   for (unsigned i = 0; i < 1000; ++i)
+   {
+      std::int64_t rand_i = randomcpp::randint(low, high);
+      EXPECT_LE(rand_i, high);
+      EXPECT_GE(rand_i, low);
+      below_zero |= rand_i < 0;
+      above_int |= rand_i > std::numeric_limits<int>::max();
+   }
+   EXPECT_TRUE(below_zero);
+   EXPECT_TRUE(above_int);
+}
+
+TEST_F(RandomIntegersTest, RandomIntegerFullRange)
+{
+   auto min = std::numeric_limits<std::int64_t>::min(), max = std::numeric_limits<std::int64_t>::max();
+   std::set<std::int64_t> seen;
+   for (unsigned i = 0; i < 100; ++i)
+   {
+      seen.insert(randomcpp::randint(min, max));
+   }
+   EXPECT_EQ(seen.size(), 100);
+
+   std::uint64_t top = 0;
+   for (unsigned i = 0; i < 100; ++i)
+   {
+      top |= randomcpp::randint(std::uint64_t(0), ~std::uint64_t(0)) >> 63;
+   }
+   EXPECT_EQ(top, 1);
+}
+
+TEST_F(RandomIntegersTest, RandomRange64WithStep)
+{
+   std::int64_t const start = std::int64_t(1) << 40;
+   for (unsigned i = 0; i < 100; ++i)
+   {
+      std::int64_t rand_i = randomcpp::randrange(start, -start, std::int64_t(-3));
+      EXPECT_LE(rand_i, start);
+      EXPECT_GT(rand_i, -start);
+      EXPECT_EQ((start - rand_i) % 3, 0);
+   }
+   EXPECT_THROW(randomcpp::randrange(std::int64_t(5), std::int64_t(5)), std::range_error);
+   EXPECT_THROW(randomcpp::randrange(std::int64_t(0), std::int64_t(5), 0), std::range_error);
+}
+
+TEST_F(RandomIntegersTest, RandBelow64IsUnbiased)
+{
+   std::uint64_t const range = 3 * (std::uint64_t(1) << 62);
+   unsigned low = 0;
+   for (unsigned i = 0; i < 30000; ++i)
+   {
+      std::uint64_t value = randomcpp::_randbelow(range);
+      EXPECT_LT(value, range);
+      low += value < (std::uint64_t(1) << 62);
+   }
+   EXPECT_NEAR(low, 10000, 400);
+}
+
+#ifdef __SIZEOF_INT128__
+TEST_F(RandomIntegersTest, RandomInteger128)
+{
+   __int128 const high = (__int128(1) << 100) + 12345;
+   bool above_64 = false;
+   for (unsigned i = 0; i < 100; ++i)
+   {
+      __int128 rand_i = randomcpp::randint(-high, high);
+      EXPECT_TRUE(rand_i <= high && rand_i >= -high);
+      above_64 |= rand_i > (__int128(1) << 64);
+   }
+   EXPECT_TRUE(above_64);
+}
+#endif
+
+TEST_F(RandomIntegersTest, SampleUnique64)
+{
+   std::int64_t const a = std::int64_t(1) << 50;
+   auto values = randomcpp::sample(a, a + (std::int64_t(1) << 40), 1000, true);
+   EXPECT_EQ(values.size(), 1000);
+   std::set<std::int64_t> unique(values.begin(), values.end());
+   EXPECT_EQ(unique.size(), 1000);
+   for (auto value : values)
+   {
+      EXPECT_GE(value, a);
+      EXPECT_LE(value, a + (std::int64_t(1) << 40));
+   }
+}
+
+TEST_F(RandomIntegersTest, SampleUniqueReachesUpperBound)
+{
+   bool seen_b = false;
+   for (unsigned i = 0; i < 200 && !seen_b; ++i)
+   {
+      for (auto value : randomcpp::sample(0, 99, 5, true))
+      {
+         seen_b |= value == 99;
+      }
+   }
+   EXPECT_TRUE(seen_b);
+}
+
+TEST_F(RandomIntegersTest, DescendingBoundedIsUniformOverTuples)
+{
+   // Four draws below 5, 4, 3, 2 come from one word; every one of the 120 tuples must be equally likely.
+   std::mt19937_64 gen(3);
+   std::vector<int> counts(120, 0);
+   for (unsigned trial = 0; trial < 60000; ++trial)
+   {
+      randomcpp::_detail::descending_bounded draw(5);
+      int index = 0;
+      for (std::uint64_t bound = 5; bound > 1; --bound)
+      {
+         std::uint64_t value = draw(gen);
+         ASSERT_LT(value, bound);
+         index = index * static_cast<int>(bound) + static_cast<int>(value);
+      }
+      ++counts[index];
+   }
+   for (auto count : counts)
+   {
+      EXPECT_NEAR(count, 500, 110);
+   }
+}
+
+TEST_F(RandomIntegersTest, DescendingBoundedBatchesEngineCalls)
+{
+   struct counting_engine
+   {
+      using result_type = std::uint64_t;
+      static constexpr result_type min() { return 0; }
+      static constexpr result_type max() { return ~result_type(0); }
+      result_type operator()()
+      {
+         ++calls;
+         return engine();
+      }
+      randomcpp::splitmix64 engine{7};
+      unsigned calls = 0;
+   } gen;
+
+   randomcpp::_detail::descending_bounded draw(1000);
+   for (unsigned i = 0; i < 999; ++i)
+   {
+      draw(gen);
+   }
+   // Bounds up to 1000 go six or five to a word.
+   EXPECT_LT(gen.calls, 220);
+}
+
+TEST_F(RandomIntegersTest, SampleUniqueSparseIsUniform)
+{
+   // The hash-map path (k < n / 10) must give every value the same chance k / n.
+   randomcpp::Random rng(2);
+   std::vector<int> counts(100, 0);
+   for (unsigned trial = 0; trial < 20000; ++trial)
+   {
+      for (auto value : rng.sample(0, 99, 5, true))
+      {
+         ++counts[value];
+      }
+   }
+   for (auto count : counts)
+   {
+      EXPECT_NEAR(count, 1000, 150);
+   }
+}
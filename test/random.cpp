@@ -4,6 +4,7 @@
 
 #include <randomcpp.hpp>
 #include <map>
+#include <thread>
 
 class RandomTest : public ::testing::Test
 {
@@ -99,3 +100,91 @@ TEST_F(RandomTest, RandomVectorInvalidRange)
    randomcpp::reset();
    EXPECT_THROW(randomcpp::sample(0, 5, 20, true), std::exception);
 }
+
+TEST_F(RandomTest, InstancesWithSameSeedAreRepeatable)
+{
+   randomcpp::Random rng_1(7), rng_2(7);
+   for (unsigned i = 0; i < 100; ++i)
+   {
+      EXPECT_EQ(rng_1.randint(0, 1000), rng_2.randint(0, 1000));
+      EXPECT_EQ(rng_1.random(), rng_2.random());
+   }
+}
+
+TEST_F(RandomTest, InstancesDoNotShareState)
+{
+   randomcpp::reset();
+   int rand_1 = randomcpp::randint(0, 1000000);
+   randomcpp::reset();
+   randomcpp::Random rng(1);
+   for (unsigned i = 0; i < 100; ++i)
+   {
+      rng.randint(0, 1000000);
+   }
+   int rand_2 = randomcpp::randint(0, 1000000);
+   EXPECT_EQ(rand_1, rand_2);
+}
+
+TEST_F(RandomTest, InstanceMatchesModuleFunctions)
+{
+   randomcpp::seed(5);
+   randomcpp::Random rng(5);
+   for (unsigned i = 0; i < 100; ++i)
+   {
+      EXPECT_EQ(randomcpp::randrange(0, 100, 3), rng.randrange(0, 100, 3));
+   }
+   randomcpp::seed(1);
+}
+
+TEST_F(RandomTest, SetStateResumesSequence)
+{
+   randomcpp::randint(0, 10);
+   auto state = randomcpp::getstate();
+   std::vector<int> first, second;
+   for (unsigned i = 0; i < 1000; ++i)
+   {
+      first.push_back(randomcpp::randint(0, 1000000));
+   }
+   randomcpp::setstate(state);
+   for (unsigned i = 0; i < 1000; ++i)
+   {
+      second.push_back(randomcpp::randint(0, 1000000));
+   }
+   EXPECT_EQ(first, second);
+}
+
+TEST_F(RandomTest, ThreadInstancesAreReproduciblePerStream)
+{
+   auto draw = [](std::uint64_t stream, std::vector<int> *out) {
+      randomcpp::set_thread_stream(stream);
+      for (unsigned i = 0; i < 20; ++i)
+      {
+         out->push_back(randomcpp::thread_instance().randint(0, 1000000));
+      }
+   };
+   std::vector<int> first_1, first_2, second_1, second_2;
+   std::thread(draw, 1, &first_1).join();
+   std::thread(draw, 2, &first_2).join();
+   std::thread(draw, 2, &second_2).join();
+   std::thread(draw, 1, &second_1).join();
+   EXPECT_EQ(first_1, second_1);
+   EXPECT_EQ(first_2, second_2);
+   EXPECT_NE(first_1, first_2);
+}
+
+TEST_F(RandomTest, ThreadInstancesFollowSeed)
+{
+   std::vector<int> before, after;
+   auto draw = [](std::vector<int> *out) {
+      randomcpp::set_thread_stream(3);
+      for (unsigned i = 0; i < 20; ++i)
+      {
+         out->push_back(randomcpp::thread_instance().randint(0, 1000000));
+      }
+   };
+   std::thread(draw, &before).join();
+   randomcpp::seed(2);
+   std::thread(draw, &after).join();
+   randomcpp::seed(1);
+   EXPECT_NE(before, after);
+}
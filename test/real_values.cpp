@@ -2,6 +2,9 @@
 
 #include <randomcpp.hpp>
 #include <map>
+#include <vector>
+#include <numeric>
+#include <algorithm>
 
 static void display_histogram(std::map<int, int> const &hist)
 {
@@ -197,4 +200,350 @@ TEST_F(RandomRealValuesTest, NormalVariateDist)
    stddev = std::sqrt(stddev / 10000);
    EXPECT_EQ(std::round(mean), 8.0f);
    EXPECT_EQ(std::round(stddev), 4.0f);
-}
\ No newline at end of file
+}
+
+TEST_F(RandomRealValuesTest, BulkRandomIsAlwaysInCorrectRange)
+{
+   std::vector<float> values(5000);
+   randomcpp::random(values);
+   auto [min, max] = std::minmax_element(values.begin(), values.end());
+   EXPECT_GE(*min, 0.0f);
+   EXPECT_LT(*max, 1.0f);
+   EXPECT_GT(*max, 0.9985f);
+   EXPECT_LT(*min, 0.0015f);
+
+   randomcpp::BasicRandom<randomcpp::sfmt19937> rng(1);
+   rng.uniform(values, 2.0f, 3.0f);
+   std::tie(min, max) = std::minmax_element(values.begin(), values.end());
+   EXPECT_GE(*min, 2.0f);
+   EXPECT_LE(*max, 3.0f);
+}
+
+TEST_F(RandomRealValuesTest, BulkExpoVariateDist)
+{
+   std::vector<float> values(5000);
+   randomcpp::expovariate(values, 1.0f / 9);
+   float mean = std::accumulate(values.begin(), values.end(), 0.0f) / values.size();
+   EXPECT_EQ(std::round(mean), 9.0f);
+}
+
+TEST_F(RandomRealValuesTest, BulkGaussianDist)
+{
+   std::vector<float> values(10001);
+   randomcpp::gauss(values, 5.0f, 2.0f);
+   float mean = 0.0f, stddev = 0.0f;
+   for (auto u : values)
+   {
+      mean += u;
+      stddev += (u - 5.0f) * (u - 5.0f);
+   }
+   mean /= values.size();
+   stddev = std::sqrt(stddev / values.size());
+   EXPECT_NEAR(mean, 5.0f, 0.1f);
+   EXPECT_NEAR(stddev, 2.0f, 0.1f);
+   // The radius uniform has 53 bits even for floats, so the largest radius is about 8.6 sigma, not 5.8.
+   EXPECT_GT(randomcpp::_detail::box_muller(~0ULL, 0ULL, 0.0f, 1.0f).first, 8.5f);
+}
+
+TEST_F(RandomRealValuesTest, ZigguratGaussianDist)
+{
+   float mean = 0.0f, stddev = 0.0f;
+   int tail = 0;
+   for (int n = 0; n < 100000; ++n)
+   {
+      float u = randomcpp::gauss(5.0f, 2.0f, randomcpp::ziggurat);
+      mean += u;
+      float delta = u - 5.0f;
+      stddev += delta * delta;
+      // Beyond the base layer (r = 3.654 sigma): about 26 expected
+      tail += std::abs(delta) > 2.0f * 3.6542f;
+   }
+   mean /= 100000;
+   stddev = std::sqrt(stddev / 100000);
+   EXPECT_NEAR(mean, 5.0f, 0.05f);
+   EXPECT_NEAR(stddev, 2.0f, 0.05f);
+   EXPECT_GT(tail, 5);
+   EXPECT_LT(tail, 60);
+}
+
+TEST_F(RandomRealValuesTest, ZigguratNormalVariateDist)
+{
+   std::vector<float> values(10000);
+   for (auto &u : values)
+   {
+      u = randomcpp::normalvariate(8.0f, 4.0f, randomcpp::ziggurat);
+   }
+   float mean = std::accumulate(values.begin(), values.end(), 0.0f) / values.size();
+   EXPECT_EQ(std::round(mean), 8.0f);
+}
+
+TEST_F(RandomRealValuesTest, ZigguratExpoVariateDist)
+{
+   float mean = 0.0f;
+   for (int n = 0; n < 5000; ++n)
+   {
+      float u = randomcpp::expovariate(1.0f / 9, randomcpp::ziggurat);
+      EXPECT_GE(u, 0.0f);
+      mean += u;
+   }
+   mean /= 5000;
+   EXPECT_EQ(std::round(mean), 9.0f);
+}
+
+TEST_F(RandomRealValuesTest, ZigguratBulkDists)
+{
+   std::vector<float> values(20001);
+   randomcpp::gauss(values, -3.0f, 0.5f, randomcpp::ziggurat);
+   float mean = std::accumulate(values.begin(), values.end(), 0.0f) / values.size();
+   EXPECT_NEAR(mean, -3.0f, 0.02f);
+
+   randomcpp::expovariate(values, 2.0f, randomcpp::ziggurat);
+   mean = std::accumulate(values.begin(), values.end(), 0.0f) / values.size();
+   EXPECT_NEAR(mean, 0.5f, 0.02f);
+   EXPECT_GE(*std::min_element(values.begin(), values.end()), 0.0f);
+}
+
+TEST_F(RandomRealValuesTest, ParallelFillIgnoresThreadCount)
+{
+   std::size_t n = (1 << 17) + 1001;
+   std::vector<float> one(n), many(n);
+   randomcpp::parallel_fill<randomcpp::GaussDist<>>(one, {2.0f, 3.0f}, 42, 1);
+   randomcpp::parallel_fill<randomcpp::GaussDist<>>(many, {2.0f, 3.0f}, 42, 4);
+   EXPECT_EQ(one, many);
+   float mean = std::accumulate(one.begin(), one.end(), 0.0f) / n;
+   EXPECT_NEAR(mean, 2.0f, 0.05f);
+
+   randomcpp::parallel_fill(many, randomcpp::UniformDist{-1.0f, 1.0f}, 42, 3);
+   EXPECT_NE(one, many);
+   EXPECT_GE(*std::min_element(many.begin(), many.end()), -1.0f);
+   EXPECT_LE(*std::max_element(many.begin(), many.end()), 1.0f);
+
+   randomcpp::parallel_fill(one, randomcpp::ExpoDist{0.5f}, 7, 2);
+   EXPECT_GE(*std::min_element(one.begin(), one.end()), 0.0f);
+
+   std::vector<int> dice_one(n), dice_many(n);
+   randomcpp::parallel_fill(dice_one, randomcpp::RandintDist<int>{1, 6}, 9, 1);
+   randomcpp::parallel_fill(dice_many, randomcpp::RandintDist<int>{1, 6}, 9, 8);
+   EXPECT_EQ(dice_one, dice_many);
+   EXPECT_EQ(*std::min_element(dice_one.begin(), dice_one.end()), 1);
+   EXPECT_EQ(*std::max_element(dice_one.begin(), dice_one.end()), 6);
+}
+
+TEST_F(RandomRealValuesTest, BulkDistributionsInDouble)
+{
+   randomcpp::Random rng(12);
+   std::vector<double> values(100001);
+   rng.gauss(values, 1.0, 2.0);
+   double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+   EXPECT_NEAR(mean, 1.0, 0.03);
+   rng.gauss(values, -3.0, 0.5, randomcpp::ziggurat);
+   mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+   EXPECT_NEAR(mean, -3.0, 0.01);
+   randomcpp::expovariate(values, 4.0);
+   mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+   EXPECT_NEAR(mean, 0.25, 0.005);
+   rng.expovariate(values, 4.0, randomcpp::ziggurat);
+   EXPECT_GE(*std::min_element(values.begin(), values.end()), 0.0);
+
+   std::vector<double> one(70000), many(70000);
+   randomcpp::parallel_fill(one, randomcpp::GaussDist{2.0, 3.0}, 5, 1);
+   randomcpp::parallel_fill(many, randomcpp::GaussDist{2.0, 3.0}, 5, 3);
+   EXPECT_EQ(one, many);
+   randomcpp::parallel_fill(many, randomcpp::ExpoDist{2.0}, 5, 3);
+   EXPECT_NEAR(std::accumulate(many.begin(), many.end(), 0.0) / many.size(), 0.5, 0.01);
+   randomcpp::parallel_fill(many, randomcpp::UniformDist<double>{}, 5, 3);
+   EXPECT_NEAR(std::accumulate(many.begin(), many.end(), 0.0) / many.size(), 0.5, 0.01);
+}
+
+TEST_F(RandomRealValuesTest, RandomDoubleHas53BitResolution)
+{
+   bool finer_than_float = false;
+   for (unsigned i = 0; i < 1000; ++i)
+   {
+      double u = randomcpp::random_double();
+      EXPECT_GE(u, 0.0);
+      EXPECT_LT(u, 1.0);
+      EXPECT_EQ(std::ldexp(u, 53), std::floor(std::ldexp(u, 53)));
+      finer_than_float |= std::ldexp(u, 24) != std::floor(std::ldexp(u, 24));
+
+      double x = randomcpp::uniform<double>(-2.0, 3.0);
+      EXPECT_GE(x, -2.0);
+      EXPECT_LE(x, 3.0);
+   }
+   EXPECT_TRUE(finer_than_float);
+   EXPECT_EQ(randomcpp::_detail::to_double(~0ULL), 1.0 - 0x1.0p-53);
+   EXPECT_EQ(randomcpp::_detail::to_float(~0U), 1.0f - 0x1.0p-24f);
+}
+
+template <typename TEngine>
+static void expect_bulk_matches_scalar()
+{
+   randomcpp::BasicRandom<TEngine> scalar(4), bulk(4);
+   std::vector<float> floats(300);
+   std::vector<double> doubles(300);
+   bulk.random(floats);
+   bulk.random(doubles);
+   for (auto u : floats)
+   {
+      ASSERT_EQ(u, scalar.random());
+   }
+   for (auto u : doubles)
+   {
+      ASSERT_EQ(u, scalar.random_double());
+   }
+}
+
+TEST_F(RandomRealValuesTest, BulkRandomMatchesScalar)
+{
+   expect_bulk_matches_scalar<std::mt19937>();
+   expect_bulk_matches_scalar<std::mt19937_64>();
+   expect_bulk_matches_scalar<randomcpp::xoshiro256pp>();
+   expect_bulk_matches_scalar<randomcpp::sfmt19937>();
+}
+
+template <typename TReal>
+static void expect_distributions_at_precision()
+{
+   randomcpp::Random rng(2);
+   static_assert(std::is_same_v<decltype(rng.gauss<TReal>(0, 1)), TReal>);
+   static_assert(std::is_same_v<decltype(randomcpp::weibullvariate<TReal>(1, 2)), TReal>);
+   TReal gauss_sum = 0, gamma_sum = 0, beta_sum = 0;
+   for (int i = 0; i < 20000; ++i)
+   {
+      gauss_sum += rng.gauss<TReal>(3, 2);
+      gamma_sum += rng.gammavariate<TReal>(TReal(2.5), 2);
+      beta_sum += rng.betavariate<TReal>(2, 6);
+      TReal u = rng.random<TReal>();
+      ASSERT_GE(u, TReal(0));
+      ASSERT_LT(u, TReal(1));
+      TReal t = rng.triangular<TReal>(0, 1, TReal(0.2));
+      ASSERT_GE(t, TReal(0));
+      ASSERT_LE(t, TReal(1));
+      ASSERT_GE(rng.paretovariate<TReal>(3), TReal(1));
+      TReal theta = rng.vonmisesvariate<TReal>(1, 4);
+      ASSERT_LE(std::abs(theta - 1), std::numbers::pi_v<TReal>);
+   }
+   EXPECT_NEAR(double(gauss_sum / 20000), 3.0, 0.05);
+   EXPECT_NEAR(double(gamma_sum / 20000), 5.0, 0.1);
+   EXPECT_NEAR(double(beta_sum / 20000), 0.25, 0.01);
+}
+
+TEST_F(RandomRealValuesTest, DistributionsAtEveryPrecision)
+{
+   expect_distributions_at_precision<float>();
+   expect_distributions_at_precision<double>();
+   expect_distributions_at_precision<long double>();
+}
+
+template <typename TDistribution, typename TCall>
+static void expect_distribution_matches_function(TDistribution const &distribution, TCall call)
+{
+   randomcpp::Random by_object(6), by_function(6), by_fill(6);
+   std::vector<typename TDistribution::result_type> filled(500);
+   distribution.fill(by_fill, filled);
+   for (auto value : filled)
+   {
+      auto expected = call(by_function);
+      ASSERT_EQ(distribution(by_object), expected);
+      ASSERT_EQ(value, expected);
+   }
+}
+
+TEST_F(RandomRealValuesTest, DistributionObjectsMatchFunctions)
+{
+   for (float alpha : {0.5f, 1.0f, 3.5f})
+   {
+      expect_distribution_matches_function(randomcpp::GammaDist<float>(alpha, 2.0f),
+                                           [&](randomcpp::Random &rng) { return rng.gammavariate(alpha, 2.0f); });
+   }
+   expect_distribution_matches_function(randomcpp::BetaDist<double>(2.0, 0.5),
+                                        [](randomcpp::Random &rng) { return rng.betavariate<double>(2.0, 0.5); });
+   expect_distribution_matches_function(randomcpp::VonMisesDist<float>(1.0f, 3.0f),
+                                        [](randomcpp::Random &rng) { return rng.vonmisesvariate(1.0f, 3.0f); });
+   expect_distribution_matches_function(randomcpp::ParetoDist<float>(2.0f),
+                                        [](randomcpp::Random &rng) { return rng.paretovariate(2.0f); });
+   expect_distribution_matches_function(randomcpp::WeibullDist<double>(1.5, 0.7),
+                                        [](randomcpp::Random &rng) { return rng.weibullvariate<double>(1.5, 0.7); });
+
+   std::mt19937 engine(3);
+   randomcpp::GammaDist<double> gamma(9.0, 0.5);
+   double sum = 0.0;
+   for (int i = 0; i < 10000; ++i)
+   {
+      sum += gamma(engine);
+   }
+   EXPECT_NEAR(sum / 10000, 4.5, 0.05);
+   EXPECT_THROW(randomcpp::GammaDist<float>(-1.0f, 1.0f), std::invalid_argument);
+
+   std::vector<float> values(70000);
+   randomcpp::parallel_fill(values, randomcpp::BetaDist<float>(2.0f, 2.0f), 1, 2);
+   EXPECT_NEAR(std::accumulate(values.begin(), values.end(), 0.0) / values.size(), 0.5, 0.01);
+}
+
+TEST_F(RandomRealValuesTest, GammaMomentsAcrossShapes)
+{
+   randomcpp::Random rng(8);
+   for (double alpha : {0.05, 0.3, 1.0, 3.5, 40.0})
+   {
+      randomcpp::GammaDist<double> gamma(alpha, 2.0);
+      double sum = 0.0, sum_sq = 0.0;
+      for (int i = 0; i < 200000; ++i)
+      {
+         double x = gamma(rng);
+         ASSERT_GE(x, 0.0);
+         sum += x;
+         sum_sq += x * x;
+      }
+      double mean = sum / 200000, variance = sum_sq / 200000 - mean * mean;
+      EXPECT_NEAR(mean / (2.0 * alpha), 1.0, 0.02) << "alpha " << alpha;
+      EXPECT_NEAR(variance / (4.0 * alpha), 1.0, 0.06) << "alpha " << alpha;
+   }
+   EXPECT_THROW(randomcpp::GammaDist<float>(0.0f, 1.0f), std::invalid_argument);
+}
+
+TEST_F(RandomRealValuesTest, BetaWithTinyShapes)
+{
+   randomcpp::Random rng(9);
+   randomcpp::BetaDist<float> beta(0.01f, 0.01f);
+   int ones = 0;
+   for (int i = 0; i < 20000; ++i)
+   {
+      float x = beta(rng);
+      ASSERT_GE(x, 0.0f);
+      ASSERT_LE(x, 1.0f);
+      ones += x > 0.5f;
+   }
+   EXPECT_NEAR(ones / 20000.0, 0.5, 0.02);
+}
+
+TEST_F(RandomRealValuesTest, DirichletVariate)
+{
+   randomcpp::Random rng(10);
+   std::vector<double> alphas{0.5, 2.0, 7.5};
+   std::vector<double> out(3 * 50000);
+   rng.dirichletvariate(alphas, std::span<double>(out));
+   std::vector<double> means(3, 0.0);
+   for (std::size_t i = 0; i < out.size(); i += 3)
+   {
+      ASSERT_NEAR(out[i] + out[i + 1] + out[i + 2], 1.0, 1e-12);
+      for (std::size_t j = 0; j < 3; ++j)
+      {
+         means[j] += out[i + j] / 50000;
+      }
+   }
+   EXPECT_NEAR(means[0], 0.05, 0.003);
+   EXPECT_NEAR(means[1], 0.2, 0.003);
+   EXPECT_NEAR(means[2], 0.75, 0.003);
+
+   std::vector<float> tiny{1e-3f, 1e-3f};
+   auto draw = randomcpp::dirichletvariate(tiny);
+   ASSERT_EQ(draw.size(), 2u);
+   EXPECT_FLOAT_EQ(draw[0] + draw[1], 1.0f);
+
+   randomcpp::Random by_function(11), by_object(11);
+   randomcpp::DirichletDist<double> dirichlet(alphas);
+   EXPECT_EQ(by_function.dirichletvariate(alphas), dirichlet(by_object));
+   EXPECT_THROW(rng.dirichletvariate(std::vector<double>{}), std::invalid_argument);
+   EXPECT_THROW(rng.dirichletvariate(std::vector<double>{1.0, 0.0}), std::invalid_argument);
+   EXPECT_THROW(rng.dirichletvariate(alphas, std::span<double>(out.data(), 4)), std::invalid_argument);
+}
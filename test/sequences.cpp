@@ -10,6 +10,9 @@
 #include <unordered_set>
 #include <string>
 #include <forward_list>
+#include <numeric>
+#include <cmath>
+#include <span>
 
 // Helper function for approximately comparing floats
 bool approximately_equal(float a, float b, float tolerance = 0.0001f)
@@ -458,3 +461,538 @@ TEST(RandomSequencesTest, HasResizeHelper)
    has = randomcpp::_detail::has_resize<std::array<int, 10>>::value;
    EXPECT_FALSE(has);
 }
+
+// Sample strategies
+TEST(RandomSequencesTest, SampleWholePopulationIsPermutation)
+{
+   std::vector<int> sequence(50);
+   std::iota(sequence.begin(), sequence.end(), 0);
+   auto sub_seq = randomcpp::sample(sequence, 50);
+   EXPECT_TRUE(std::is_permutation(sub_seq.begin(), sub_seq.end(), sequence.begin()));
+}
+
+TEST(RandomSequencesTest, SampleLargerThanPopulationThrows)
+{
+   std::vector<int> sequence = {1, 2, 3};
+   EXPECT_THROW(randomcpp::sample(sequence, 4), std::range_error);
+}
+
+TEST(RandomSequencesTest, SampleIsUniformForSmallAndLargeK)
+{
+   // k = 2 of 40 takes Floyd's path, k = 30 of 40 the partial shuffle; every element and
+   // every position of the result should be equally likely in both.
+   std::vector<int> sequence(40);
+   std::iota(sequence.begin(), sequence.end(), 0);
+   for (std::size_t k : {2, 30})
+   {
+      std::vector<int> first_counts(40, 0), counts(40, 0);
+      unsigned const rounds = 20000;
+      for (unsigned i = 0; i < rounds; ++i)
+      {
+         auto sub_seq = randomcpp::sample(sequence, k);
+         ++first_counts[sub_seq[0]];
+         for (auto el : sub_seq)
+         {
+            ++counts[el];
+         }
+      }
+      for (int el = 0; el < 40; ++el)
+      {
+         EXPECT_NEAR(first_counts[el], rounds / 40.0, 120);
+         EXPECT_NEAR(counts[el], rounds * k / 40.0, 6 * std::sqrt(rounds * k / 40.0));
+      }
+   }
+}
+
+TEST(RandomSequencesTest, SampleFromLargePopulation)
+{
+   std::vector<std::uint32_t> sequence(2000000);
+   std::iota(sequence.begin(), sequence.end(), 0u);
+   auto sub_seq = randomcpp::sample(sequence, 200000);
+   std::set<std::uint32_t> unique(sub_seq.begin(), sub_seq.end());
+   EXPECT_EQ(unique.size(), sub_seq.size());
+}
+
+TEST(RandomSequencesTest, SampleFromLargeMapInOnePass)
+{
+   std::map<int, int> map;
+   for (int i = 0; i < 1000000; ++i)
+   {
+      map.emplace_hint(map.end(), i, -i);
+   }
+   auto sub_map = randomcpp::sample(map, 5000);
+   EXPECT_EQ(sub_map.size(), 5000);
+   for (const auto &el : sub_map)
+   {
+      EXPECT_EQ(el.second, -el.first);
+   }
+}
+
+TEST(RandomSequencesTest, SampleListKeepsSelectionOrderRandom)
+{
+   std::list<int> sequence(30);
+   std::iota(sequence.begin(), sequence.end(), 0);
+   std::vector<int> first_counts(30, 0);
+   for (unsigned i = 0; i < 6000; ++i)
+   {
+      ++first_counts[randomcpp::sample(sequence, 5).front()];
+   }
+   for (auto count : first_counts)
+   {
+      EXPECT_NEAR(count, 200, 75);
+   }
+}
+
+TEST(RandomSequencesTest, SampleIntegerForwardList)
+{
+   std::forward_list<int> sequence;
+   for (int i = 0; i < 60; i += 4)
+   {
+      sequence.push_front(i);
+   }
+   std::set<int> uniqueness_checker;
+   for (const auto &el : randomcpp::sample(sequence, 15))
+   {
+      EXPECT_EQ(el % 4, 0);
+      EXPECT_TRUE(uniqueness_checker.insert(el).second);
+   }
+}
+
+// Reservoir
+TEST(RandomSequencesTest, ReservoirKeepsEverythingUntilFull)
+{
+   randomcpp::Reservoir<int> reservoir(10);
+   for (int i = 0; i < 7; ++i)
+   {
+      reservoir.push(i);
+   }
+   EXPECT_EQ(reservoir.seen(), 7);
+   EXPECT_EQ(reservoir.sample(), (std::vector<int>{0, 1, 2, 3, 4, 5, 6}));
+}
+
+TEST(RandomSequencesTest, ReservoirIsUniform)
+{
+   std::vector<int> stream(100);
+   std::iota(stream.begin(), stream.end(), 0);
+   std::vector<int> single_counts(100, 0), batch_counts(100, 0);
+   for (unsigned run = 0; run < 4000; ++run)
+   {
+      randomcpp::Reservoir<int> single(10, run), batched(10, run, 1);
+      for (auto item : stream)
+      {
+         single.push(item);
+      }
+      batched.push(std::span<int const>(stream).first(35));
+      batched.push(std::span<int const>(stream).subspan(35));
+      EXPECT_EQ(single.seen(), 100);
+      EXPECT_EQ(batched.seen(), 100);
+      for (auto item : single.sample())
+      {
+         ++single_counts[item];
+      }
+      for (auto item : batched.sample())
+      {
+         ++batch_counts[item];
+      }
+   }
+   for (int item = 0; item < 100; ++item)
+   {
+      EXPECT_NEAR(single_counts[item], 400, 80);
+      EXPECT_NEAR(batch_counts[item], 400, 80);
+   }
+}
+
+TEST(RandomSequencesTest, ReservoirMergeIsUniform)
+{
+   // 40 items on one side, 120 on the other, then 40 more pushed after merging: each of the 200 should be kept
+   // with probability 10/200.
+   std::vector<int> counts(200, 0);
+   for (unsigned run = 0; run < 6000; ++run)
+   {
+      randomcpp::Reservoir<int> left(10, run, 1), right(10, run, 2);
+      for (int item = 0; item < 40; ++item)
+      {
+         left.push(item);
+      }
+      for (int item = 40; item < 160; ++item)
+      {
+         right.push(item);
+      }
+      left.merge(right);
+      for (int item = 160; item < 200; ++item)
+      {
+         left.push(item);
+      }
+      EXPECT_EQ(left.seen(), 200);
+      ASSERT_EQ(left.sample().size(), 10);
+      for (auto item : left.sample())
+      {
+         ++counts[item];
+      }
+   }
+   for (int item = 0; item < 200; ++item)
+   {
+      EXPECT_NEAR(counts[item], 300, 75);
+   }
+}
+
+// Choices Tests
+TEST(RandomSequencesTest, ChoicesUniform)
+{
+   std::list<int> sequence = {5, 6, 7, 8, 9};
+   auto picks = randomcpp::choices(sequence, 100);
+   EXPECT_EQ(picks.size(), 100);
+   for (auto pick : picks)
+   {
+      EXPECT_GE(pick, 5);
+      EXPECT_LE(pick, 9);
+   }
+   EXPECT_THROW(randomcpp::choices(std::vector<int>{}, 3), std::logic_error);
+}
+
+TEST(RandomSequencesTest, ChoicesWeighted)
+{
+   std::vector<char> sequence = {'a', 'b', 'c', 'd'};
+   std::vector<double> weights = {1.0, 0.0, 3.0, 6.0};
+   std::map<char, int> counts;
+   for (auto pick : randomcpp::choices(sequence, weights, 20000))
+   {
+      ++counts[pick];
+   }
+   EXPECT_EQ(counts['b'], 0);
+   EXPECT_NEAR(counts['a'], 2000, 200);
+   EXPECT_NEAR(counts['c'], 6000, 300);
+   EXPECT_NEAR(counts['d'], 12000, 300);
+
+   std::vector<double> cum = {1.0, 1.0, 4.0, 10.0};
+   counts.clear();
+   for (auto pick : randomcpp::choices(sequence, randomcpp::cum_weights, cum, 20000))
+   {
+      ++counts[pick];
+   }
+   EXPECT_EQ(counts['b'], 0);
+   EXPECT_NEAR(counts['d'], 12000, 300);
+
+   EXPECT_THROW(randomcpp::choices(sequence, std::vector<double>{1.0, 2.0}), std::invalid_argument);
+   EXPECT_THROW(randomcpp::choices(sequence, std::vector<double>{0.0, 0.0, 0.0, 0.0}), std::invalid_argument);
+}
+
+TEST(RandomSequencesTest, AliasTableMatchesWeights)
+{
+   std::vector<double> weights = {0.5, 0.0, 2.0, 1.0, 0.25, 0.25};
+   randomcpp::AliasTable table(weights);
+   EXPECT_EQ(table.size(), 6);
+
+   randomcpp::Random rng(3);
+   std::vector<std::size_t> draws(40000);
+   table(rng, draws);
+   std::vector<int> counts(6, 0);
+   for (auto index : draws)
+   {
+      ASSERT_LT(index, 6);
+      ++counts[index];
+   }
+   EXPECT_EQ(counts[1], 0);
+   for (std::size_t i = 0; i < 6; ++i)
+   {
+      double expected = 40000 * weights[i] / 4.0;
+      EXPECT_NEAR(counts[i], expected, 5 * std::sqrt(expected) + 1);
+   }
+
+   std::vector<std::string> endpoints = {"a", "b", "c", "d", "e", "f"};
+   for (auto const &pick : randomcpp::choices(endpoints, table, 50))
+   {
+      EXPECT_NE(pick, "b");
+   }
+   EXPECT_THROW(randomcpp::AliasTable(std::vector<double>{}), std::invalid_argument);
+   EXPECT_THROW(randomcpp::AliasTable(std::vector<double>{1.0, -1.0}), std::invalid_argument);
+}
+
+// DynamicWeightedSampler Tests
+TEST(RandomSequencesTest, DynamicWeightedSamplerUpdates)
+{
+   randomcpp::DynamicWeightedSampler sampler(std::vector<double>{1.0, 1.0, 2.0});
+   EXPECT_EQ(sampler.size(), 3);
+   EXPECT_DOUBLE_EQ(sampler.total(), 4.0);
+
+   sampler.update(0, 0.0);
+   sampler.update(2, 6.0);
+   EXPECT_DOUBLE_EQ(sampler.total(), 7.0);
+
+   randomcpp::Random rng(11);
+   std::vector<std::size_t> draws(35000);
+   sampler(rng, draws);
+   std::vector<int> counts(3, 0);
+   for (auto index : draws)
+   {
+      ++counts[index];
+   }
+   EXPECT_EQ(counts[0], 0);
+   EXPECT_NEAR(counts[1], 5000, 300);
+   EXPECT_NEAR(counts[2], 30000, 300);
+
+   EXPECT_THROW(sampler.update(3, 1.0), std::out_of_range);
+   EXPECT_THROW(sampler.update(1, -1.0), std::invalid_argument);
+}
+
+TEST(RandomSequencesTest, DynamicWeightedSamplerInsertErase)
+{
+   randomcpp::DynamicWeightedSampler sampler;
+   randomcpp::Random rng(5);
+   EXPECT_THROW(sampler(rng), std::logic_error);
+
+   for (int i = 0; i < 100; ++i)
+   {
+      EXPECT_EQ(sampler.insert(1.0), i);
+   }
+   EXPECT_DOUBLE_EQ(sampler.total(), 100.0);
+   for (std::size_t i = 0; i < 100; i += 2)
+   {
+      sampler.erase(i);
+   }
+   EXPECT_THROW(sampler.erase(0), std::out_of_range);
+   EXPECT_THROW(sampler.weight(0), std::out_of_range);
+   for (int i = 0; i < 1000; ++i)
+   {
+      EXPECT_EQ(sampler(rng) % 2, 1);
+   }
+
+   EXPECT_EQ(sampler.insert(3.0), 98);
+   EXPECT_EQ(sampler.size(), 100);
+   EXPECT_DOUBLE_EQ(sampler.weight(98), 3.0);
+   EXPECT_DOUBLE_EQ(sampler.total(), 53.0);
+
+   std::vector<int> endpoints(100);
+   std::iota(endpoints.begin(), endpoints.end(), 0);
+   auto pick = randomcpp::choice(endpoints, sampler);
+   EXPECT_TRUE(pick % 2 == 1 || pick == 98);
+   EXPECT_THROW(randomcpp::choice(std::vector<int>(5), sampler), std::invalid_argument);
+}
+
+// Weighted Sample Tests
+TEST(RandomSequencesTest, WeightedSampleUnique)
+{
+   std::list<int> population = {0, 1, 2, 3, 4, 5, 6, 7};
+   std::vector<double> weights = {1, 0, 2, 3, 0, 4, 5, 6};
+   randomcpp::Random rng(8);
+   for (int trial = 0; trial < 200; ++trial)
+   {
+      auto picks = rng.weighted_sample(population, weights, 6);
+      std::set<int> unique(picks.begin(), picks.end());
+      EXPECT_EQ(picks.size(), 6);
+      EXPECT_EQ(unique.size(), 6);
+      EXPECT_EQ(unique.count(1), 0);
+      EXPECT_EQ(unique.count(4), 0);
+   }
+   EXPECT_TRUE(rng.weighted_sample(population, weights, 0).empty());
+   EXPECT_THROW(rng.weighted_sample(population, weights, 7), std::range_error);
+   EXPECT_THROW(rng.weighted_sample(population, weights, 9), std::range_error);
+   EXPECT_THROW(rng.weighted_sample(population, std::vector<double>{1, 2}, 1), std::invalid_argument);
+   EXPECT_THROW(rng.weighted_sample(population, std::vector<double>{1, 1, 1, 1, 1, 1, 1, -1}, 1), std::invalid_argument);
+}
+
+TEST(RandomSequencesTest, WeightedSampleDrawOrder)
+{
+   // The first element is a single weighted draw and the smallest weight's inclusion follows sequential drawing.
+   std::vector<int> population(200);
+   std::iota(population.begin(), population.end(), 0);
+   std::vector<double> weights(200);
+   std::iota(weights.begin(), weights.end(), 1.0);
+
+   randomcpp::Random rng(21);
+   const int trials = 20000;
+   int upper_first = 0;
+   for (int trial = 0; trial < trials; ++trial)
+   {
+      upper_first += rng.weighted_sample(population, weights, 10).front() >= 100;
+   }
+   EXPECT_NEAR(upper_first / double(trials), 15050.0 / 20100.0, 0.015);
+
+   std::vector<int> small = {0, 1, 2, 3};
+   std::vector<double> small_weights = {1, 2, 3, 4};
+   int included = 0;
+   for (int trial = 0; trial < trials; ++trial)
+   {
+      auto picks = rng.weighted_sample(small, small_weights, 2);
+      included += picks[0] == 0 || picks[1] == 0;
+   }
+   double expected = 0.1 + 0.2 / 8 + 0.3 / 7 + 0.4 / 6;
+   EXPECT_NEAR(included / double(trials), expected, 0.015);
+}
+
+TEST(RandomSequencesTest, ParallelWeightedSampleIgnoresThreadCount)
+{
+   std::vector<int> population(300000);
+   std::iota(population.begin(), population.end(), 0);
+   std::vector<double> weights(population.size(), 1.0);
+   for (std::size_t i = 0; i < weights.size(); i += 3)
+   {
+      weights[i] = 0.0;
+   }
+
+   randomcpp::Random one(4), four(4);
+   auto serial = one.parallel_weighted_sample(population, weights, 50, 1);
+   auto threaded = four.parallel_weighted_sample(population, weights, 50, 4);
+   EXPECT_EQ(serial, threaded);
+   randomcpp::Random three(4);
+   EXPECT_EQ(three.parallel_weighted_sample(population, weights, 50, 3), serial);
+   // The chunk streams are keyed by 64 bits of the generator: two 32-bit mt19937 outputs.
+   randomcpp::Random after(4);
+   after.engine().discard(2);
+   EXPECT_EQ(one(), after());
+   std::set<int> unique(serial.begin(), serial.end());
+   EXPECT_EQ(unique.size(), 50);
+   for (auto pick : serial)
+   {
+      EXPECT_NE(pick % 3, 0);
+   }
+   EXPECT_THROW(one.parallel_weighted_sample(population, std::vector<double>(10, 1.0), 5), std::invalid_argument);
+}
+
+TEST(RandomSequencesTest, WeightedReservoirMerge)
+{
+   randomcpp::WeightedReservoir<int> left(5, 1), right(5, 1, 2);
+   for (int i = 0; i < 1000; ++i)
+   {
+      (i < 500 ? left : right).push(i, i % 2 ? 1.0 : 0.0);
+   }
+   left.merge(right);
+   EXPECT_EQ(left.seen(), 1000);
+   auto sample = left.sample();
+   EXPECT_EQ(sample.size(), 5);
+   for (auto item : sample)
+   {
+      EXPECT_EQ(item % 2, 1);
+   }
+   EXPECT_THROW(left.merge(left), std::invalid_argument);
+   EXPECT_THROW(randomcpp::WeightedReservoir<int>(0), std::invalid_argument);
+
+   // A heavy item late in a long stream is still found after the reservoir has started jumping.
+   int hits = 0;
+   for (unsigned seed = 0; seed < 2000; ++seed)
+   {
+      randomcpp::WeightedReservoir<int> reservoir(1, seed);
+      for (int i = 0; i < 999; ++i)
+      {
+         reservoir.push(i, 1.0);
+      }
+      reservoir.push(999, 999.0);
+      hits += reservoir.sample().front() == 999;
+   }
+   EXPECT_NEAR(hits / 2000.0, 0.5, 0.05);
+}
+
+// Parallel Shuffle Tests
+TEST(RandomSequencesTest, MergeShuffledIsUniform)
+{
+   randomcpp::Random rng(17);
+   std::map<std::vector<int>, int> counts;
+   const int trials = 60000;
+   for (int trial = 0; trial < trials; ++trial)
+   {
+      std::vector<int> items = {0, 1, 2, 3, 4};
+      randomcpp::_detail::shuffle_range(items.begin(), items.begin() + 2, rng);
+      randomcpp::_detail::shuffle_range(items.begin() + 2, items.end(), rng);
+      randomcpp::_detail::merge_shuffled(items.begin(), items.begin() + 2, items.end(), rng);
+      ++counts[items];
+   }
+   EXPECT_EQ(counts.size(), 120);
+   for (auto const &[permutation, count] : counts)
+   {
+      EXPECT_NEAR(count, trials / 120, 110);
+   }
+}
+
+TEST(RandomSequencesTest, ParallelShuffleIgnoresThreadCount)
+{
+   std::vector<std::uint32_t> one(300000), three;
+   std::iota(one.begin(), one.end(), 0);
+   three = one;
+
+   randomcpp::Random a(9), b(9);
+   a.parallel_shuffle(&one, 1);
+   b.parallel_shuffle(&three, 3);
+   EXPECT_EQ(one, three);
+   // The task streams are keyed by 64 bits of the generator: two 32-bit mt19937 outputs.
+   randomcpp::Random after(9);
+   after.engine().discard(2);
+   EXPECT_EQ(a(), after());
+
+   auto sorted = one;
+   std::sort(sorted.begin(), sorted.end());
+   for (std::uint32_t i = 0; i < sorted.size(); ++i)
+   {
+      ASSERT_EQ(sorted[i], i);
+   }
+   // Elements from the first block end up spread over the whole range.
+   std::size_t moved = 0;
+   for (std::uint32_t i = 0; i < 1000; ++i)
+   {
+      moved += one[i] >= 65536;
+   }
+   EXPECT_GT(moved, 700);
+
+   std::vector<int> small = {1, 2, 3};
+   randomcpp::parallel_shuffle(&small);
+   std::sort(small.begin(), small.end());
+   EXPECT_EQ(small, (std::vector<int>{1, 2, 3}));
+}
+
+// Cache-Blocked Shuffle Tests
+TEST(RandomSequencesTest, PrefetchShuffleMatchesFisherYates)
+{
+   std::vector<std::uint32_t> shuffled(1 << 19), expected;
+   std::iota(shuffled.begin(), shuffled.end(), 0);
+   expected = shuffled;
+
+   randomcpp::Random a(6), b(6);
+   a.shuffle(&shuffled);
+   randomcpp::_detail::descending_bounded targets(expected.size());
+   for (std::uint32_t i = expected.size() - 1; i > 0; --i)
+   {
+      std::swap(expected[i], expected[targets(b)]);
+   }
+   EXPECT_EQ(shuffled, expected);
+}
+
+TEST(RandomSequencesTest, BlockedShuffleIsUniform)
+{
+   // A tiny cache size forces several rounds of dealing, even on four elements.
+   randomcpp::Random rng(12);
+   std::map<std::vector<int>, int> counts;
+   const int trials = 48000;
+   for (int trial = 0; trial < trials; ++trial)
+   {
+      std::vector<int> items = {0, 1, 2, 3};
+      randomcpp::_detail::blocked_shuffle(items.begin(), items.end(), rng, sizeof(int));
+      ++counts[items];
+   }
+   EXPECT_EQ(counts.size(), 24);
+   for (auto const &[permutation, count] : counts)
+   {
+      EXPECT_NEAR(count, trials / 24, 200);
+   }
+}
+
+TEST(RandomSequencesTest, BlockedShuffleIsPermutation)
+{
+   std::vector<std::uint64_t> items(1 << 17);
+   std::iota(items.begin(), items.end(), 0);
+   randomcpp::shuffle(&items, randomcpp::cache_blocked);
+   std::size_t fixed = 0;
+   for (std::size_t i = 0; i < items.size(); ++i)
+   {
+      fixed += items[i] == i;
+   }
+   EXPECT_LT(fixed, 20);
+   std::sort(items.begin(), items.end());
+   for (std::size_t i = 0; i < items.size(); ++i)
+   {
+      ASSERT_EQ(items[i], i);
+   }
+
+   std::string strings[] = {"a", "b", "c", "d"};
+   randomcpp::shuffle(&strings, randomcpp::cache_blocked);
+   std::sort(std::begin(strings), std::end(strings));
+   EXPECT_EQ(strings[3], "d");
+}
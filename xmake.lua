@@ -11,7 +11,32 @@ target("randomcpp_test")
         "test/integers.cpp", 
         "test/random.cpp", 
         "test/real_values.cpp", 
-        "test/sequences.cpp"
+        "test/sequences.cpp", 
+        "test/engines.cpp"
     )
 
 
+
+target("randomcpp_bench")
+    set_kind("binary")
+    set_default(false)
+    add_includedirs("include")
+    add_files("bench/contention.cpp")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+
+target("randomcpp_bench_engines")
+    set_kind("binary")
+    set_default(false)
+    add_includedirs("include")
+    add_files("bench/engines.cpp")
+
+target("randomcpp_bench_shuffle")
+    set_kind("binary")
+    set_default(false)
+    add_includedirs("include")
+    add_files("bench/shuffle.cpp")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end